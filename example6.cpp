@@ -0,0 +1,289 @@
+#include "systemc.h"
+#include <algorithm>
+#include <string>
+#include <iostream>
+#include <vector>
+
+// Interfaces of the batched FIFO. Besides whole batches copied in and out,
+// the acquire/commit calls hand out a pointer straight into the ring buffer,
+// so a model can build or parse its data in place.
+template <class T>
+class batch_fifo_out_if : virtual public sc_interface
+{
+public:
+    virtual void write_n(const T* data, size_t n) = 0;      // Blocks until all n are written
+    virtual size_t nb_write_n(const T* data, size_t n) = 0; // Writes what fits, returns the count
+    virtual size_t acquire_write(T*& ptr) = 0;              // Contiguous free space at ptr
+    virtual void commit_write(size_t n) = 0;
+    virtual size_t num_free() const = 0;
+    virtual const sc_event& data_read_event() const = 0;
+};
+
+template <class T>
+class batch_fifo_in_if : virtual public sc_interface
+{
+public:
+    virtual size_t read_n(T* data, size_t max) = 0;         // Blocks until at least one is read
+    virtual size_t nb_read_n(T* data, size_t max) = 0;      // Reads what is there, returns the count
+    virtual size_t acquire_read(const T*& ptr) = 0;         // Contiguous data at ptr
+    virtual void commit_read(size_t n) = 0;
+    virtual size_t num_available() const = 0;
+    virtual const sc_event& data_written_event() const = 0;
+};
+
+// A FIFO channel that moves whole batches per call, so a producer and a
+// consumer handshake once per batch instead of once per element. Like
+// sc_fifo, written data becomes readable and read space becomes writable
+// in the update phase. It also measures itself: how long it sat at each
+// occupancy, how long writers waited for space and readers for data, and
+// the elements and calls in each direction.
+template <class T>
+class batch_fifo : public sc_prim_channel, public batch_fifo_out_if<T>, public batch_fifo_in_if<T>
+{
+public:
+    std::vector<sc_time> occupancy_time; // Time spent holding 0..capacity elements
+    sc_time full_stall_time;             // Writers waiting for space
+    sc_time empty_stall_time;            // Readers waiting for data
+    uint64_t elements_written, elements_read;
+    uint64_t write_calls, read_calls;
+
+    explicit batch_fifo(const char* name, size_t capacity = 16) :
+        sc_prim_channel(name), occupancy_time(capacity + 1), elements_written(0), elements_read(0),
+        write_calls(0), read_calls(0), buffer(capacity), read_index(0), write_index(0),
+        num_readable(0), num_read(0), num_written(0), update_requested(false) {}
+
+    size_t capacity() const { return buffer.size(); }
+
+    size_t num_free() const override { return buffer.size() - num_readable - num_written; }
+    size_t num_available() const override { return num_readable - num_read; }
+    const sc_event& data_read_event() const override { return read_event; }
+    const sc_event& data_written_event() const override { return written_event; }
+
+    size_t acquire_write(T*& ptr) override
+    {
+        ptr = &buffer[write_index];
+        return std::min(num_free(), buffer.size() - write_index);
+    }
+
+    void commit_write(size_t n) override
+    {
+        write_index = (write_index + n) % buffer.size();
+        num_written += n;
+        elements_written += n;
+        ++write_calls;
+        request_update_once();
+    }
+
+    size_t acquire_read(const T*& ptr) override
+    {
+        ptr = &buffer[read_index];
+        return std::min(num_available(), buffer.size() - read_index);
+    }
+
+    void commit_read(size_t n) override
+    {
+        read_index = (read_index + n) % buffer.size();
+        num_read += n;
+        elements_read += n;
+        ++read_calls;
+        request_update_once();
+    }
+
+    size_t nb_write_n(const T* data, size_t n) override
+    {
+        size_t done = 0;
+        T* ptr;
+        // At most two pieces, either side of the end of the ring
+        while (done < n)
+        {
+            size_t k = std::min(acquire_write(ptr), n - done);
+            if (k == 0)
+            {
+                break;
+            }
+            std::copy(data + done, data + done + k, ptr);
+            commit_write(k);
+            done += k;
+        }
+        return done;
+    }
+
+    size_t nb_read_n(T* data, size_t max) override
+    {
+        size_t done = 0;
+        const T* ptr;
+        while (done < max)
+        {
+            size_t k = std::min(acquire_read(ptr), max - done);
+            if (k == 0)
+            {
+                break;
+            }
+            std::copy(ptr, ptr + k, data + done);
+            commit_read(k);
+            done += k;
+        }
+        return done;
+    }
+
+    void write_n(const T* data, size_t n) override
+    {
+        size_t done = nb_write_n(data, n);
+        while (done < n)
+        {
+            sc_time start = sc_time_stamp();
+            wait(read_event);
+            full_stall_time += sc_time_stamp() - start;
+            done += nb_write_n(data + done, n - done);
+        }
+    }
+
+    size_t read_n(T* data, size_t max) override
+    {
+        while (num_available() == 0)
+        {
+            sc_time start = sc_time_stamp();
+            wait(written_event);
+            empty_stall_time += sc_time_stamp() - start;
+        }
+        return nb_read_n(data, max);
+    }
+
+    // Elements read per second of simulated time so far
+    double throughput() const
+    {
+        double seconds = sc_time_stamp().to_seconds();
+        return seconds > 0 ? elements_read / seconds : 0.0;
+    }
+
+    void dump(std::ostream& os = std::cout) const
+    {
+        os << name() << ": " << elements_written << " written in " << write_calls << " calls, "
+           << elements_read << " read in " << read_calls << " calls, "
+           << throughput() / 1e9 << " elements/ns" << std::endl;
+        os << "  stalled full " << full_stall_time << ", empty " << empty_stall_time << std::endl;
+        sc_time total = sc_time_stamp();
+        for (size_t i = 0; i < occupancy_time.size(); ++i)
+        {
+            // The current occupancy has been held since the last update
+            sc_time t = occupancy_time[i] + (i == num_readable ? total - last_change : SC_ZERO_TIME);
+            if (total > SC_ZERO_TIME && t > SC_ZERO_TIME)
+            {
+                os << "  occupancy " << i << ": " << 100.0 * (t / total) << "%" << std::endl;
+            }
+        }
+    }
+
+protected:
+    void update() override
+    {
+        occupancy_time[num_readable] += sc_time_stamp() - last_change;
+        last_change = sc_time_stamp();
+        if (num_read > 0)
+        {
+            read_event.notify(SC_ZERO_TIME);
+        }
+        if (num_written > 0)
+        {
+            written_event.notify(SC_ZERO_TIME);
+        }
+        num_readable = num_readable - num_read + num_written;
+        num_read = 0;
+        num_written = 0;
+        update_requested = false;
+    }
+
+private:
+    std::vector<T> buffer;
+    size_t read_index, write_index;
+    size_t num_readable;          // Readable since the last update
+    size_t num_read, num_written; // In this delta cycle
+    bool update_requested;
+    sc_event read_event, written_event;
+    sc_time last_change;
+
+    void request_update_once()
+    {
+        if (!update_requested)
+        {
+            update_requested = true;
+            request_update();
+        }
+    }
+};
+
+const size_t BATCH = 8;
+
+SC_MODULE(Producer)
+{
+    sc_port<batch_fifo_out_if<int>> out_fifo;
+
+    void produce()
+    {
+        int packet[BATCH];
+        for (int i = 0; i < 64; i += BATCH)
+        {
+            wait(1, SC_NS);
+            for (size_t j = 0; j < BATCH; ++j)
+            {
+                packet[j] = i + j;
+            }
+            out_fifo->write_n(packet, BATCH);
+            SC_REPORT_INFO("Producer", (sc_time_stamp().to_string() + ": Produced " + std::to_string(i) +
+                                        ".." + std::to_string(i + BATCH - 1)).c_str());
+        }
+    }
+
+    SC_CTOR(Producer)
+    {
+        SC_THREAD(produce);
+    }
+};
+
+SC_MODULE(Consumer)
+{
+    sc_port<batch_fifo_in_if<int>> in_fifo;
+
+    void consume()
+    {
+        while (true)
+        {
+            // Sum the data in place, without copying it out of the FIFO
+            while (in_fifo->num_available() == 0)
+            {
+                wait(in_fifo->data_written_event());
+            }
+            const int* data;
+            size_t n = in_fifo->acquire_read(data);
+            int sum = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                sum += data[i];
+            }
+            in_fifo->commit_read(n);
+            SC_REPORT_INFO("Consumer", (sc_time_stamp().to_string() + ": Consumed " + std::to_string(n) +
+                                        " elements, sum " + std::to_string(sum)).c_str());
+            wait(2, SC_NS);
+        }
+    }
+
+    SC_CTOR(Consumer)
+    {
+        SC_THREAD(consume);
+    }
+};
+
+int sc_main(int argc, char *argv[])
+{
+    Producer prod("prod");
+    Consumer cons("cons");
+    batch_fifo<int> fifo("fifo", 20); // Room for two and a half batches
+
+    prod.out_fifo.bind(fifo);
+    cons.in_fifo.bind(fifo);
+
+    sc_start(40, SC_NS);
+    fifo.dump();
+
+    return 0;
+}
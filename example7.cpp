@@ -0,0 +1,253 @@
+#include "systemc.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Reader side of host_bridge, for the one SystemC process that consumes it
+template <class T>
+class host_bridge_in_if : virtual public sc_interface
+{
+public:
+    // Appends everything pushed so far to out, in push order per writer.
+    // Blocks while nothing is queued; returns false once every writer has
+    // closed and all was read.
+    virtual bool read_batch(std::vector<T>& out) = 0;
+    // Never blocks; returns the number of items appended
+    virtual size_t nb_read_batch(std::vector<T>& out) = 0;
+};
+
+// A channel that carries data from ordinary host threads into the
+// simulation. Any number of host threads push; one SystemC process reads
+// through host_bridge_in_if.
+//
+// Pushing is lock-free: items are linked onto a list with a single
+// compare-and-swap, and push_n links a whole batch first so it costs one.
+// Only a push onto an empty list wakes the kernel, through
+// async_request_update, the one sc_prim_channel call that is safe from
+// another thread. The reader then takes everything pushed so far in one
+// exchange, so a single wake-up drains as many items as were queued.
+//
+// While host threads may still push, the channel keeps the simulation
+// from ending for lack of events (async_attach_suspending, SystemC 2.3.2
+// and later); it lets go once every writer has called close().
+template <class T>
+class host_bridge : public sc_prim_channel, public host_bridge_in_if<T>
+{
+public:
+    uint64_t items_read, batches_read, wakeups;
+
+    host_bridge(const char* name, unsigned writers) :
+        sc_prim_channel(name), items_read(0), batches_read(0), wakeups(0),
+        head(nullptr), open_writers(writers), detached(false)
+    {
+        async_attach_suspending();
+    }
+
+    ~host_bridge()
+    {
+        delete_list(head.load());
+    }
+
+    // Host side, from any thread
+    void push(const T& value)
+    {
+        Node* node = new Node { value, nullptr };
+        link(node, node);
+    }
+
+    void push_n(const T* values, size_t n)
+    {
+        if (n == 0)
+        {
+            return;
+        }
+        // Newest first, as the reader expects
+        Node* first = nullptr;
+        Node* last = nullptr;
+        for (size_t i = 0; i < n; ++i)
+        {
+            first = new Node { values[i], first };
+            if (last == nullptr)
+            {
+                last = first;
+            }
+        }
+        link(first, last);
+    }
+
+    void close()
+    {
+        if (open_writers.fetch_sub(1) == 1)
+        {
+            async_request_update();
+        }
+    }
+
+    // Simulation side
+    bool read_batch(std::vector<T>& out) override
+    {
+        while (nb_read_batch(out) == 0)
+        {
+            if (open_writers.load() == 0 && head.load() == nullptr)
+            {
+                return false;
+            }
+            wait(data_event);
+            ++wakeups;
+        }
+        return true;
+    }
+
+    size_t nb_read_batch(std::vector<T>& out) override
+    {
+        Node* node = head.exchange(nullptr);
+        if (node == nullptr)
+        {
+            return 0;
+        }
+        // The list is newest first; append it reversed
+        size_t begin = out.size();
+        while (node != nullptr)
+        {
+            Node* next = node->next;
+            out.push_back(node->value);
+            delete node;
+            node = next;
+        }
+        std::reverse(out.begin() + begin, out.end());
+        size_t n = out.size() - begin;
+        items_read += n;
+        ++batches_read;
+        return n;
+    }
+
+    void dump(std::ostream& os = std::cout) const
+    {
+        os << name() << ": " << items_read << " items in " << batches_read << " batches, "
+           << wakeups << " wake-ups" << std::endl;
+    }
+
+protected:
+    // Kernel thread, after any async_request_update
+    void update() override
+    {
+        data_event.notify(SC_ZERO_TIME);
+        if (open_writers.load() == 0 && !detached)
+        {
+            detached = true;
+            async_detach_suspending();
+        }
+    }
+
+private:
+    struct Node
+    {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> head; // Newest item
+    std::atomic<unsigned> open_writers;
+    bool detached;
+    sc_event data_event;
+
+    // Publish the chain first..last, newest first, with one CAS
+    void link(Node* first, Node* last)
+    {
+        Node* old = head.load();
+        do
+        {
+            last->next = old;
+        } while (!head.compare_exchange_weak(old, first));
+        if (old == nullptr)
+        {
+            async_request_update();
+        }
+    }
+
+    static void delete_list(Node* node)
+    {
+        while (node != nullptr)
+        {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+};
+
+SC_MODULE(Consumer)
+{
+    sc_port<host_bridge_in_if<int>> bridge;
+
+    void consume()
+    {
+        std::vector<int> batch;
+        while (bridge->read_batch(batch))
+        {
+            long sum = 0;
+            for (int value : batch)
+            {
+                sum += value;
+            }
+            // 1 ns per item, but only one process activation per batch
+            wait(static_cast<double>(batch.size()), SC_NS);
+            SC_REPORT_INFO("Consumer", (sc_time_stamp().to_string() + ": Consumed " + std::to_string(batch.size()) +
+                                        " items, sum " + std::to_string(sum)).c_str());
+            batch.clear();
+        }
+        SC_REPORT_INFO("Consumer", (sc_time_stamp().to_string() + ": All writers closed").c_str());
+    }
+
+    SC_CTOR(Consumer)
+    {
+        SC_THREAD(consume);
+    }
+};
+
+// Stands in for a host thread decoding a trace or reading a file: it
+// produces chunks of data at its own pace, unaware of simulated time.
+static void produce(host_bridge<int>& bridge, int id)
+{
+    std::vector<int> chunk;
+    for (int i = 0; i < 10; ++i)
+    {
+        chunk.clear();
+        for (int j = 0; j < 16; ++j)
+        {
+            chunk.push_back(id * 1000 + i * 16 + j);
+        }
+        bridge.push_n(chunk.data(), chunk.size());
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    bridge.close();
+}
+
+int sc_main(int argc, char *argv[])
+{
+    const unsigned WRITERS = 2;
+    host_bridge<int> bridge("bridge", WRITERS);
+    Consumer cons("cons");
+    cons.bridge.bind(bridge);
+
+    std::vector<std::thread> writers;
+    for (unsigned i = 0; i < WRITERS; ++i)
+    {
+        writers.emplace_back(produce, std::ref(bridge), i);
+    }
+
+    sc_start(); // Runs until the writers are done and every item is consumed
+
+    for (std::thread& t : writers)
+    {
+        t.join();
+    }
+    bridge.dump();
+
+    return 0;
+}
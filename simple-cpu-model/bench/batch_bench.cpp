@@ -0,0 +1,146 @@
+// Throughput benchmark for BatchRunner.
+//
+// Builds a batch of independent jobs from the workloads in workloads.h, each
+// with its own pseudo-random data (as a fuzzing run would), runs it once on
+// a single thread and once on the requested number of threads, and prints
+// one JSON document with jobs and instructions per host second for both.
+// It then runs the batch once more on LaneCore, 16 jobs sharing a program
+// at a time on a single thread. All three runs must produce identical final
+// states.
+//
+// usage: simple_cpu_batch_bench [--jobs N] [--instructions N] [--threads N]
+//                               [--output FILE]
+#include <systemc.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "batch_runner.h"
+#include "lane_core.h"
+#include "workloads.h"
+
+struct BatchBenchConfig {
+    size_t jobs = 1000;
+    uint64_t instructions = 100000; // Per job
+    unsigned threads = 0;           // 0: one per hardware thread
+    std::string output;
+};
+
+static std::vector<BatchJob> make_jobs(const BatchBenchConfig& config) {
+    std::vector<Workload> workloads = make_workloads();
+    std::vector<BatchJob> jobs(config.jobs);
+    uint32_t seed = 0x2545F491;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const Workload& workload = workloads[i % workloads.size()];
+        jobs[i].program.assign(workload.program.begin(), workload.program.end());
+        jobs[i].data.resize(workload.data.size());
+        for (uint16_t& w : jobs[i].data) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            w = static_cast<uint16_t>(seed);
+        }
+        jobs[i].max_instructions = config.instructions;
+    }
+    return jobs;
+}
+
+static bool same_state(const BatchResult& a, const BatchResult& b) {
+    return a.stop_reason == b.stop_reason && a.instructions == b.instructions && a.pc == b.pc &&
+           std::memcmp(a.registers, b.registers, sizeof(a.registers)) == 0 && a.memory == b.memory;
+}
+
+static std::string describe_run(unsigned threads, unsigned lanes, const std::vector<BatchResult>& results, double wall) {
+    uint64_t instructions = 0;
+    for (const BatchResult& r : results) {
+        instructions += r.instructions;
+    }
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "{\"threads\": %u, \"lanes\": %u, \"jobs\": %zu, \"instructions\": %llu, \"wall_seconds\": %.6f, "
+        "\"jobs_per_second\": %.1f, \"instructions_per_second\": %.1f}",
+        threads, lanes, results.size(), static_cast<unsigned long long>(instructions), wall,
+        wall > 0 ? results.size() / wall : 0.0, wall > 0 ? instructions / wall : 0.0);
+    return buf;
+}
+
+static std::string run_timed(const BatchRunner& runner, const std::vector<BatchJob>& jobs,
+                             std::vector<BatchResult>& results) {
+    auto start = std::chrono::steady_clock::now();
+    results = runner.run(jobs);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return describe_run(runner.threads(), 1, results, wall);
+}
+
+// make_jobs cycles through the workloads, so job i runs program
+// i % workloads. Each group of jobs sharing a program goes to run_test_vectors.
+static std::string run_lanes_timed(const std::vector<BatchJob>& jobs, size_t programs,
+                                   std::vector<BatchResult>& results) {
+    const unsigned LANES = 16;
+    results.assign(jobs.size(), BatchResult());
+    auto start = std::chrono::steady_clock::now();
+    for (size_t p = 0; p < programs && p < jobs.size(); ++p) {
+        std::vector<std::vector<uint16_t>> data_sets;
+        for (size_t i = p; i < jobs.size(); i += programs) {
+            data_sets.push_back(jobs[i].data);
+        }
+        std::vector<BatchResult> group = run_test_vectors<LANES>(jobs[p].program, data_sets, jobs[p].max_instructions);
+        for (size_t k = 0; k < group.size(); ++k) {
+            results[p + k * programs] = std::move(group[k]);
+        }
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return describe_run(1, LANES, results, wall);
+}
+
+int sc_main(int argc, char* argv[]) {
+    BatchBenchConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--jobs" && has_value) {
+            config.jobs = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--instructions" && has_value) {
+            config.instructions = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--threads" && has_value) {
+            config.threads = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--output" && has_value) {
+            config.output = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: %s [--jobs N] [--instructions N] [--threads N] [--output FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<BatchJob> jobs = make_jobs(config);
+    std::vector<BatchResult> serial, parallel, lanes;
+    std::string serial_json = run_timed(BatchRunner(1), jobs, serial);
+    std::fprintf(stderr, "%s\n", serial_json.c_str());
+    std::string parallel_json = run_timed(BatchRunner(config.threads), jobs, parallel);
+    std::fprintf(stderr, "%s\n", parallel_json.c_str());
+    std::string lanes_json = run_lanes_timed(jobs, make_workloads().size(), lanes);
+    std::fprintf(stderr, "%s\n", lanes_json.c_str());
+
+    bool match = serial.size() == parallel.size() && serial.size() == lanes.size();
+    for (size_t i = 0; match && i < serial.size(); ++i) {
+        match = same_state(serial[i], parallel[i]) && same_state(serial[i], lanes[i]);
+    }
+
+    std::string json = "{\"serial\": " + serial_json + ",\n \"parallel\": " + parallel_json +
+                       ",\n \"lanes\": " + lanes_json +
+                       ",\n \"results_match\": " + (match ? "true" : "false") + "}\n";
+    if (config.output.empty()) {
+        std::fputs(json.c_str(), stdout);
+    } else {
+        FILE* f = std::fopen(config.output.c_str(), "w");
+        if (f == nullptr) {
+            std::perror(config.output.c_str());
+            return 1;
+        }
+        std::fputs(json.c_str(), f);
+        std::fclose(f);
+    }
+    return match ? 0 : 1;
+}
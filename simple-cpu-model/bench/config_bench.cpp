@@ -0,0 +1,182 @@
+// Design-space sweep over CpuConfig.
+//
+// Runs the workloads in workloads.h on BasicFunctionalCore in the 8, 16 and
+// 32-bit word configurations of common.h, all compiled into this one
+// binary, and prints one JSON document with instructions per host second
+// for each. Each run is checked against a plain reference interpreter at
+// the full width of its configuration; results_match reports whether every
+// final state (PC, registers and data memory, all bits) agreed.
+//
+// usage: simple_cpu_config_bench [--instructions N] [--workload NAME]...
+//                                [--output FILE]
+#include <systemc.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "decoder.h"
+#include "functional_core.h"
+#include "workloads.h"
+
+struct ConfigBenchConfig {
+    uint64_t instructions = 10000000; // Per run
+    std::vector<std::string> workloads; // Empty: all
+    std::string output;
+};
+
+// Final state at full width
+struct SweepState {
+    FunctionalCoreBase::StopReason stop_reason = FunctionalCoreBase::RUNNING;
+    uint64_t instructions = 0;
+    unsigned pc = 0;
+    std::vector<uint64_t> words; // Registers, then data memory
+
+    bool operator==(const SweepState& other) const {
+        return stop_reason == other.stop_reason && instructions == other.instructions && pc == other.pc &&
+               words == other.words;
+    }
+};
+
+// The ISA executed one decode at a time on 64-bit values masked to
+// Config's widths. It shares nothing with BasicFunctionalCore but the
+// decoder, so a core that loses bits or mishandles a width disagrees.
+template <class Config>
+static SweepState run_reference(const Workload& workload, uint64_t instructions) {
+    std::vector<uint16_t> program(workload.program.begin(), workload.program.end());
+    std::vector<uint64_t> registers(Config::NUM_REGISTERS, 0);
+    std::vector<uint64_t> memory(1u << Config::ADDR_SIZE, 0);
+    for (size_t i = 0; i < workload.data.size() && i < memory.size(); ++i) {
+        memory[i] = workload.data[i].to_uint64() & Config::WORD_MASK;
+    }
+
+    SweepState state;
+    unsigned pc = 0;
+    while (state.instructions < instructions && state.stop_reason == FunctionalCoreBase::RUNNING) {
+        if (pc >= program.size()) {
+            state.stop_reason = FunctionalCoreBase::PC_OUT_OF_BOUNDS;
+            break;
+        }
+        DecodedInstruction insn = decode_instruction(program[pc], pc, Config::ADDR_SIZE);
+        uint64_t& rd = registers[Config::register_index(insn.rd)];
+        uint64_t rs1 = registers[Config::register_index(insn.rs1)];
+        uint64_t rs2 = registers[Config::register_index(insn.rs2)];
+        unsigned next = (pc + 1) & Config::ADDR_MASK;
+        switch (insn.opcode) {
+            case LOAD:  rd = memory[insn.immediate]; break;
+            case STORE: memory[insn.immediate] = rs1; break;
+            case ADD:   rd = (rs1 + rs2) & Config::WORD_MASK; break;
+            case SUB:   rd = (rs1 - rs2) & Config::WORD_MASK; break;
+            case BEQZ:  next = rs1 == 0 ? insn.target : next; break;
+            case BNEZ:  next = rs1 != 0 ? insn.target : next; break;
+            case JMP:   next = insn.target; break;
+            case HALT:  state.stop_reason = FunctionalCoreBase::HALTED; break;
+            case WFI:   state.stop_reason = FunctionalCoreBase::WAITING_FOR_INTERRUPT; continue;
+            default:    break; // Unknown opcodes are no-ops
+        }
+        ++state.instructions;
+        if (state.stop_reason == FunctionalCoreBase::RUNNING) {
+            pc = next;
+        }
+    }
+    state.pc = pc;
+    state.words = registers;
+    state.words.insert(state.words.end(), memory.begin(), memory.end());
+    return state;
+}
+
+template <class Config>
+static std::string run_config(const Workload& workload, uint64_t instructions, bool& match) {
+    typedef typename BasicFunctionalCore<Config>::data_word data_word;
+    SweepState state;
+    BasicFunctionalCore<Config> core;
+    core.report_unknown_opcodes = false;
+    core.load_program(std::vector<uint16_t>(workload.program.begin(), workload.program.end()));
+    for (size_t i = 0; i < workload.data.size() && i < core.memory.size(); ++i) {
+        core.memory[i] = static_cast<data_word>(workload.data[i].to_uint64() & Config::WORD_MASK);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    state.stop_reason = core.run(instructions);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    state.instructions = core.instructions_executed;
+    state.pc = core.pc;
+    state.words.assign(core.registers, core.registers + Config::NUM_REGISTERS);
+    state.words.insert(state.words.end(), core.memory.begin(), core.memory.end());
+
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "{\"workload\": \"%s\", \"word_size\": %d, \"addr_size\": %d, \"registers\": %d, \"instructions\": %llu, "
+        "\"wall_seconds\": %.6f, \"instructions_per_second\": %.1f}",
+        workload.name.c_str(), Config::WORD_SIZE, Config::ADDR_SIZE, Config::NUM_REGISTERS,
+        static_cast<unsigned long long>(core.instructions_executed), wall,
+        wall > 0 ? core.instructions_executed / wall : 0.0);
+    if (!(state == run_reference<Config>(workload, instructions))) {
+        std::fprintf(stderr, "%s: %d-bit words differ from the reference\n", workload.name.c_str(), Config::WORD_SIZE);
+        match = false;
+    }
+    return buf;
+}
+
+static bool selected(const ConfigBenchConfig& config, const std::string& name) {
+    if (config.workloads.empty()) {
+        return true;
+    }
+    for (const std::string& w : config.workloads) {
+        if (w == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int sc_main(int argc, char* argv[]) {
+    ConfigBenchConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--instructions" && has_value) {
+            config.instructions = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--workload" && has_value) {
+            config.workloads.push_back(argv[++i]);
+        } else if (arg == "--output" && has_value) {
+            config.output = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: %s [--instructions N] [--workload NAME]... [--output FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<std::string> runs;
+    bool match = true;
+    for (const Workload& workload : make_workloads()) {
+        if (!selected(config, workload.name)) {
+            continue;
+        }
+        runs.push_back(run_config<Word8CpuConfig>(workload, config.instructions, match));
+        std::fprintf(stderr, "%s\n", runs.back().c_str());
+        runs.push_back(run_config<Word16CpuConfig>(workload, config.instructions, match));
+        std::fprintf(stderr, "%s\n", runs.back().c_str());
+        runs.push_back(run_config<Word32CpuConfig>(workload, config.instructions, match));
+        std::fprintf(stderr, "%s\n", runs.back().c_str());
+    }
+
+    std::string json = "{\"runs\": [\n";
+    for (size_t i = 0; i < runs.size(); ++i) {
+        json += "  " + runs[i] + (i + 1 < runs.size() ? ",\n" : "\n");
+    }
+    json += std::string("], \"results_match\": ") + (match ? "true" : "false") + "}\n";
+    if (config.output.empty()) {
+        std::fputs(json.c_str(), stdout);
+    } else {
+        FILE* f = std::fopen(config.output.c_str(), "w");
+        if (f == nullptr) {
+            std::perror(config.output.c_str());
+            return 1;
+        }
+        std::fputs(json.c_str(), f);
+        std::fclose(f);
+    }
+    return match ? 0 : 1;
+}
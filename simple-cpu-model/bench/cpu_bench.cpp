@@ -0,0 +1,196 @@
+// Simulation-speed benchmark for SimpleCPU.
+//
+// Runs every workload in workloads.h in every execution mode and prints one
+// JSON document with host wall time, simulated instructions per host second,
+// delta cycles and process activations per run. Each run happens in a forked
+// child process (see fork_run.h). --no-superblocks makes the ISS modes
+// dispatch one instruction at a time, for comparison. --predictor sets the
+// branch predictor, which changes the cycles PIPELINED and the ISS modes
+// take for branch_loop.
+//
+// usage: simple_cpu_bench [--instructions N] [--quantum N] [--workload NAME]...
+//                         [--mode signal|levelized|pipelined|iss|decoupled]...
+//                         [--predictor not-taken|backward-taken|bimodal|gshare]
+//                         [--no-superblocks] [--output FILE]
+#include <systemc.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "fork_run.h"
+#include "simple_cpu.h"
+#include "sim_stats.h"
+#include "workloads.h"
+
+#ifdef SIMPLE_CPU_SC_STATE
+static const char* STATE_NAME = "sc_uint";
+#else
+static const char* STATE_NAME = "native";
+#endif
+
+struct BenchConfig {
+    uint64_t instructions = 200000;
+    unsigned quantum = 1000;
+    bool superblocks = true;
+    std::string predictor; // Empty for none
+    std::vector<std::string> workloads;
+    std::vector<std::string> modes;
+    std::string output;
+};
+
+static const char* mode_name(ExecutionMode mode) {
+    switch (mode) {
+        case SIGNAL_LEVEL:   return "signal";
+        case FUNCTIONAL_ISS: return "iss";
+        case DECOUPLED_ISS:  return "decoupled";
+        case LEVELIZED:      return "levelized";
+        case PIPELINED:      return "pipelined";
+    }
+    return "unknown";
+}
+
+static bool parse_predictor(const std::string& name, BranchPredictorConfig& config) {
+    if (name == "not-taken") {
+        config.kind = PREDICT_NOT_TAKEN;
+    } else if (name == "backward-taken") {
+        config.kind = PREDICT_BACKWARD_TAKEN;
+    } else if (name == "bimodal") {
+        config.kind = PREDICT_BIMODAL;
+    } else if (name == "gshare") {
+        config.kind = PREDICT_GSHARE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool selected(const std::vector<std::string>& filter, const std::string& name) {
+    if (filter.empty()) {
+        return true;
+    }
+    for (const std::string& f : filter) {
+        if (f == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Elaborate, run and measure one case. Only ever called in a fresh child.
+static std::string run_case(const BenchConfig& config, const Workload& workload, ExecutionMode mode) {
+    sc_report_handler::set_actions(SC_INFO, SC_DO_NOTHING);
+
+    SimpleCPU cpu("cpu", mode);
+    cpu.set_instruction_limit(config.instructions);
+    if (mode == DECOUPLED_ISS) {
+        cpu.set_quantum(config.quantum);
+    }
+    cpu.core.use_superblocks = config.superblocks;
+    BranchPredictorConfig predictor_config;
+    if (parse_predictor(config.predictor, predictor_config)) {
+        cpu.set_branch_predictor(make_branch_predictor(predictor_config));
+    }
+    cpu.load_instruction_memory(workload.program);
+    cpu.load_data_memory(workload.data);
+    SimStats::process_activations = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    if (cpu.clocked()) {
+        // Instruction k is fetched at (k + 1) clock periods
+        sc_start(cpu.cycle_time * (static_cast<double>(config.instructions) + 0.5));
+    } else {
+        sc_start();
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t retired = cpu.instructions_retired();
+    uint64_t deltas = sc_delta_count();
+    double per_insn = retired > 0 ? 1.0 / retired : 0.0;
+    char buf[768];
+    std::snprintf(buf, sizeof(buf),
+        "{\"workload\": \"%s\", \"mode\": \"%s\", \"state\": \"%s\", \"superblocks\": %s, \"predictor\": \"%s\", "
+        "\"instructions\": %llu, "
+        "\"wall_seconds\": %.6f, \"instructions_per_second\": %.1f, \"delta_cycles\": %llu, "
+        "\"process_activations\": %llu, \"deltas_per_instruction\": %.2f, "
+        "\"activations_per_instruction\": %.2f, \"simulated_ns\": %.1f}",
+        workload.name.c_str(), mode_name(mode), STATE_NAME, config.superblocks ? "true" : "false",
+        config.predictor.empty() ? "none" : config.predictor.c_str(),
+        static_cast<unsigned long long>(retired), wall, wall > 0 ? retired / wall : 0.0,
+        static_cast<unsigned long long>(deltas),
+        static_cast<unsigned long long>(SimStats::process_activations),
+        deltas * per_insn, SimStats::process_activations * per_insn,
+        sc_time_stamp().to_seconds() * 1e9);
+    return buf;
+}
+
+int sc_main(int argc, char* argv[]) {
+    BenchConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--instructions" && has_value) {
+            config.instructions = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--quantum" && has_value) {
+            config.quantum = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--workload" && has_value) {
+            config.workloads.push_back(argv[++i]);
+        } else if (arg == "--mode" && has_value) {
+            config.modes.push_back(argv[++i]);
+        } else if (arg == "--predictor" && has_value) {
+            config.predictor = argv[++i];
+            BranchPredictorConfig unused;
+            if (!parse_predictor(config.predictor, unused)) {
+                std::fprintf(stderr, "unknown predictor %s\n", config.predictor.c_str());
+                return 1;
+            }
+        } else if (arg == "--no-superblocks") {
+            config.superblocks = false;
+        } else if (arg == "--output" && has_value) {
+            config.output = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: %s [--instructions N] [--quantum N] [--workload NAME]... "
+                                 "[--mode signal|levelized|pipelined|iss|decoupled]... "
+                                 "[--predictor not-taken|backward-taken|bimodal|gshare] [--no-superblocks] "
+                                 "[--output FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const ExecutionMode modes[] = { SIGNAL_LEVEL, LEVELIZED, PIPELINED, FUNCTIONAL_ISS, DECOUPLED_ISS };
+    std::vector<std::string> results;
+    for (const Workload& workload : make_workloads()) {
+        if (!selected(config.workloads, workload.name)) {
+            continue;
+        }
+        for (ExecutionMode mode : modes) {
+            if (!selected(config.modes, mode_name(mode))) {
+                continue;
+            }
+            const std::string failed = "{\"workload\": \"" + workload.name + "\", \"mode\": \"" +
+                                       mode_name(mode) + "\", \"error\": \"run failed\"}";
+            results.push_back(run_forked([&]() { return run_case(config, workload, mode); }, failed));
+            std::fprintf(stderr, "%s\n", results.back().c_str());
+        }
+    }
+
+    std::string json = "{\"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        json += "  " + results[i] + (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    json += "]}\n";
+
+    if (config.output.empty()) {
+        std::fputs(json.c_str(), stdout);
+    } else {
+        FILE* f = std::fopen(config.output.c_str(), "w");
+        if (f == nullptr) {
+            std::perror(config.output.c_str());
+            return 1;
+        }
+        std::fputs(json.c_str(), f);
+        std::fclose(f);
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+#include "fork_run.h"
+#include <cstdio>
+#include <sys/wait.h>
+#include <unistd.h>
+
+std::string run_forked(const std::function<std::string()>& run, const std::string& failed) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return failed;
+    }
+    std::fflush(nullptr);
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return failed;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        std::string result = run();
+        ssize_t written = write(fds[1], result.data(), result.size());
+        _exit(written == static_cast<ssize_t>(result.size()) ? 0 : 1);
+    }
+    close(fds[1]);
+    std::string result;
+    char buf[256];
+    ssize_t n;
+    while ((n = read(fds[0], buf, sizeof(buf))) > 0) {
+        result.append(buf, n);
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return failed;
+    }
+    return result;
+}
@@ -0,0 +1,13 @@
+#ifndef FORK_RUN_H
+#define FORK_RUN_H
+
+#include <functional>
+#include <string>
+
+// A SystemC kernel can only be elaborated once per process, so benchmarks
+// run each case in a forked child. run is called in the child and its result
+// is passed back through a pipe; if the child cannot be started or does not
+// exit cleanly, failed is returned instead.
+std::string run_forked(const std::function<std::string()>& run, const std::string& failed);
+
+#endif // FORK_RUN_H
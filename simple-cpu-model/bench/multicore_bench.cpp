@@ -0,0 +1,141 @@
+// Throughput scaling benchmark for MultiCoreSystem.
+//
+// Runs a workload from workloads.h on 1, 2, 4 and 8 cores sharing data
+// memory, with each arbitration policy, every core running the same program
+// for the same number of instructions. Prints one JSON document with, per
+// run, the simulated cycles, aggregate instructions per cycle, bus
+// utilization, and per core the CPI and the cycles spent stalled on the bus.
+// Each run happens in a forked child process (see fork_run.h).
+//
+// usage: simple_cpu_multicore_bench [--instructions N] [--workload NAME]
+//                                   [--cores N]... [--transfer-cycles N]
+//                                   [--output FILE]
+#include <systemc.h>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include "fork_run.h"
+#include "multi_core.h"
+#include "trace_log.h"
+#include "workloads.h"
+
+struct MultiCoreBenchConfig {
+    uint64_t instructions = 100000; // Per core
+    std::string workload = "load_store_stream";
+    std::vector<unsigned> cores;
+    unsigned transfer_cycles = 1;
+    std::string output;
+};
+
+static const char* policy_name(ArbitrationPolicy policy) {
+    return policy == ARBITRATE_PRIORITY ? "priority" : "round_robin";
+}
+
+// Elaborate, run and measure one case. Only ever called in a fresh child.
+static std::string run_case(const MultiCoreBenchConfig& config, const Workload& workload,
+                            unsigned cores, ArbitrationPolicy policy) {
+    sc_report_handler::set_actions(SC_INFO, SC_DO_NOTHING);
+    TraceLog::set_all_levels(TRACE_OFF);
+
+    MultiCoreSystem system("system", cores, policy, config.transfer_cycles);
+    system.set_instruction_limit(config.instructions);
+    for (const std::unique_ptr<SimpleCPU>& core : system.cores) {
+        core->load_instruction_memory(workload.program);
+    }
+    std::vector<uint16_t> data(workload.data.begin(), workload.data.end());
+    system.memory.load(data.data(), data.size());
+    sc_start();
+
+    double cycles = sc_time_stamp() / system.cores.front()->cycle_time;
+    std::string per_core;
+    for (size_t i = 0; i < system.cores.size(); ++i) {
+        const Pipeline& p = system.cores[i]->pipeline;
+        char buf[128];
+        std::snprintf(buf, sizeof(buf), "%s{\"cpi\": %.3f, \"bus_stall_cycles\": %llu}",
+                      i > 0 ? ", " : "", p.cpi(), static_cast<unsigned long long>(p.bus_stall_cycles));
+        per_core += buf;
+    }
+    std::string depth;
+    for (size_t d = 0; d < system.bus.queue_depth.size(); ++d) {
+        depth += (d > 0 ? ", " : "") + std::to_string(system.bus.queue_depth[d]);
+    }
+
+    uint64_t retired = system.instructions_retired();
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "{\"workload\": \"%s\", \"cores\": %u, \"arbiter\": \"%s\", \"instructions\": %llu, "
+        "\"cycles\": %.0f, \"ipc\": %.3f, \"bus_utilization\": %.3f, ",
+        workload.name.c_str(), cores, policy_name(policy), static_cast<unsigned long long>(retired),
+        cycles, cycles > 0 ? retired / cycles : 0.0, system.bus.utilization());
+    return buf + std::string("\"per_core\": [") + per_core + "], \"queue_depth\": [" + depth + "]}";
+}
+
+int sc_main(int argc, char* argv[]) {
+    MultiCoreBenchConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--instructions" && has_value) {
+            config.instructions = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--workload" && has_value) {
+            config.workload = argv[++i];
+        } else if (arg == "--cores" && has_value) {
+            config.cores.push_back(std::strtoul(argv[++i], nullptr, 0));
+        } else if (arg == "--transfer-cycles" && has_value) {
+            config.transfer_cycles = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--output" && has_value) {
+            config.output = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: %s [--instructions N] [--workload NAME] [--cores N]... "
+                                 "[--transfer-cycles N] [--output FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (config.cores.empty()) {
+        config.cores = { 1, 2, 4, 8 };
+    }
+
+    const Workload* workload = nullptr;
+    std::vector<Workload> workloads = make_workloads();
+    for (const Workload& w : workloads) {
+        if (w.name == config.workload) {
+            workload = &w;
+        }
+    }
+    if (workload == nullptr) {
+        std::fprintf(stderr, "unknown workload %s\n", config.workload.c_str());
+        return 1;
+    }
+
+    const ArbitrationPolicy policies[] = { ARBITRATE_ROUND_ROBIN, ARBITRATE_PRIORITY };
+    std::vector<std::string> results;
+    for (unsigned cores : config.cores) {
+        for (ArbitrationPolicy policy : policies) {
+            const std::string failed = "{\"cores\": " + std::to_string(cores) + ", \"arbiter\": \"" +
+                                       policy_name(policy) + "\", \"error\": \"run failed\"}";
+            results.push_back(run_forked([&]() { return run_case(config, *workload, cores, policy); }, failed));
+            std::fprintf(stderr, "%s\n", results.back().c_str());
+        }
+    }
+
+    std::string json = "{\"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        json += "  " + results[i] + (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    json += "]}\n";
+
+    if (config.output.empty()) {
+        std::fputs(json.c_str(), stdout);
+    } else {
+        FILE* f = std::fopen(config.output.c_str(), "w");
+        if (f == nullptr) {
+            std::perror(config.output.c_str());
+            return 1;
+        }
+        std::fputs(json.c_str(), f);
+        std::fclose(f);
+    }
+    return 0;
+}
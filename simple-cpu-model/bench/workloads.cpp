@@ -0,0 +1,93 @@
+#include "workloads.h"
+#include "decoder.h"
+
+static const unsigned PROGRAM_WORDS = 1u << ADDR_SIZE;
+static const unsigned DATA_WORDS = 64; // Reachable through the 6-bit immediate
+
+static std::vector<word> make_data() {
+    std::vector<word> data(DATA_WORDS);
+    for (unsigned i = 0; i < DATA_WORDS; ++i) {
+        data[i] = i * 3 + 1;
+    }
+    return data;
+}
+
+Workload make_alu_loop() {
+    Workload w;
+    w.name = "alu_loop";
+    // Seed R1..R7, then keep them busy
+    for (unsigned r = 1; r < NUM_REGISTERS; ++r) {
+        w.program.push_back(encode_instruction(LOAD, r, 0, r));
+    }
+    for (unsigned i = 0; w.program.size() < PROGRAM_WORDS; ++i) {
+        unsigned rd = 1 + i % 7;
+        unsigned rs1 = 1 + (i + 1) % 7;
+        unsigned rs2 = 1 + (i + 3) % 7;
+        w.program.push_back(encode_alu(i % 2 ? SUB : ADD, rd, rs1, rs2));
+    }
+    w.data = make_data();
+    return w;
+}
+
+Workload make_load_store_stream() {
+    Workload w;
+    w.name = "load_store_stream";
+    for (unsigned i = 0; w.program.size() < PROGRAM_WORDS; ++i) {
+        unsigned r = 1 + i % 7;
+        if (i % 2 == 0) {
+            w.program.push_back(encode_instruction(LOAD, r, 0, (i * 5) % DATA_WORDS));
+        } else {
+            w.program.push_back(encode_instruction(STORE, 0, r, (i * 7 + 3) % DATA_WORDS));
+        }
+    }
+    w.data = make_data();
+    return w;
+}
+
+Workload make_straight_line() {
+    Workload w;
+    w.name = "straight_line";
+    uint32_t seed = 12345;
+    while (w.program.size() < PROGRAM_WORDS) {
+        seed = seed * 1103515245u + 12345u; // Fixed LCG so runs are comparable
+        unsigned pick = (seed >> 16) % 10;
+        unsigned r = 1 + (seed >> 8) % 7;
+        unsigned other = 1 + (seed >> 4) % 7;
+        unsigned addr = (seed >> 20) % DATA_WORDS;
+        if (pick < 4) {
+            w.program.push_back(encode_alu(pick % 2 ? SUB : ADD, r, other, 1 + (r + other) % 7));
+        } else if (pick < 7) {
+            w.program.push_back(encode_instruction(LOAD, r, 0, addr));
+        } else {
+            w.program.push_back(encode_instruction(STORE, 0, r, addr));
+        }
+    }
+    w.data = make_data();
+    return w;
+}
+
+Workload make_branch_loop() {
+    Workload w;
+    w.name = "branch_loop";
+    w.program = {
+        encode_instruction(LOAD, 7, 0, 0), // R7 = step
+        encode_instruction(LOAD, 1, 0, 5), // outer: R1 = trip count
+        encode_alu(SUB, 4, 7, 4),          // inner: R4 alternates between R7 and 0
+        encode_branch(BEQZ, 4, 2),         // Taken every other iteration
+        encode_alu(ADD, 3, 3, 7),
+        encode_alu(SUB, 1, 1, 7),
+        encode_branch(BNEZ, 1, -4),        // To inner
+        encode_jump(-6)                    // To outer
+    };
+    w.data = make_data();
+    return w;
+}
+
+std::vector<Workload> make_workloads() {
+    std::vector<Workload> workloads;
+    workloads.push_back(make_alu_loop());
+    workloads.push_back(make_load_store_stream());
+    workloads.push_back(make_straight_line());
+    workloads.push_back(make_branch_loop());
+    return workloads;
+}
@@ -0,0 +1,24 @@
+#ifndef WORKLOADS_H
+#define WORKLOADS_H
+
+#include <string>
+#include <vector>
+#include "common.h"
+
+// Synthetic programs for the benchmark harness. None contains a HALT, so
+// each runs until the instruction limit: the straight-line ones fill the
+// whole instruction memory and let the PC wrap around, branch_loop loops.
+struct Workload {
+    std::string name;
+    std::vector<word> program;
+    std::vector<word> data;
+};
+
+Workload make_alu_loop();          // ADD/SUB only
+Workload make_load_store_stream(); // Alternating LOAD/STORE over 64 words
+Workload make_straight_line();     // Pseudo-random mix of LOAD, STORE, ADD and SUB
+Workload make_branch_loop();       // Counted inner loop with an alternating branch, in an endless outer loop
+
+std::vector<Workload> make_workloads();
+
+#endif // WORKLOADS_H
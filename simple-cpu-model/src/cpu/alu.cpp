@@ -1,18 +1,25 @@
 #include "alu.h"
+#include "sim_stats.h"
 
-void ALU::perform_operation()
+state_word ALU::compute(unsigned control, state_word a, state_word b)
 {
-    // Perform the operation based on the control signal
-    switch (alu_control.read().to_uint()) {
+    switch (control) {
         case 0: // ADD
-            result.write(operand1.read() + operand2.read());
-            break;
+            return mask_word(a + b);
         case 1: // SUB
-            result.write(operand1.read() - operand2.read());
-            break;
+            return mask_word(a - b);
         default:
             SC_REPORT_WARNING("ALU", "Invalid ALU control signal.");
-            result.write(0);
-            break;
+            return 0;
     }
-}
\ No newline at end of file
+}
+
+void ALU::perform_operation()
+{
+    ++SimStats::process_activations;
+
+    // Convert once at the ports and compute on state_word
+    state_word a = operand1.read();
+    state_word b = operand2.read();
+    result.write(compute(alu_control.read().to_uint(), a, b));
+}
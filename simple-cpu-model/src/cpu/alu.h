@@ -10,6 +10,9 @@ public:
     sc_out<word> result;
     void perform_operation(); 
 
+    // The operation itself, shared with the levelized datapath
+    static state_word compute(unsigned control, state_word a, state_word b);
+
     SC_CTOR(ALU) {
         SC_METHOD(perform_operation);
         sensitive << operand1 << operand2 << alu_control;
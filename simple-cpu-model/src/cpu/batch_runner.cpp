@@ -0,0 +1,108 @@
+#include "batch_runner.h"
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Job indices owned by one worker. The owner takes from the front, thieves
+// from the back, so they only meet on the last job.
+struct WorkQueue {
+    std::mutex lock;
+    std::deque<size_t> jobs;
+
+    bool pop_front(size_t& job) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (jobs.empty()) {
+            return false;
+        }
+        job = jobs.front();
+        jobs.pop_front();
+        return true;
+    }
+
+    bool steal_back(size_t& job) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (jobs.empty()) {
+            return false;
+        }
+        job = jobs.back();
+        jobs.pop_back();
+        return true;
+    }
+};
+
+} // namespace
+
+BatchRunner::BatchRunner(unsigned threads) : thread_count(threads) {
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+BatchResult BatchRunner::run_job(const BatchJob& job) {
+    FunctionalCore core;
+    core.report_unknown_opcodes = false;
+    core.load_program(job.program);
+
+    BatchResult result;
+    size_t words = std::min(job.data.size(), core.memory.size());
+    std::copy(job.data.begin(), job.data.begin() + words, core.memory.begin());
+    result.data_truncated = words < job.data.size();
+
+    result.stop_reason = core.run(job.max_instructions);
+    result.instructions = core.instructions_executed;
+    result.unknown_opcodes = core.unknown_opcodes;
+    result.pc = core.pc;
+    std::copy(core.registers, core.registers + NUM_REGISTERS, result.registers);
+    result.memory.swap(core.memory);
+    return result;
+}
+
+std::vector<BatchResult> BatchRunner::run(const std::vector<BatchJob>& jobs) const {
+    std::vector<BatchResult> results(jobs.size());
+    unsigned workers = static_cast<unsigned>(std::min<size_t>(thread_count, jobs.size()));
+    if (workers <= 1) {
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            results[i] = run_job(jobs[i]);
+        }
+        return results;
+    }
+
+    // Start every worker with an equal, contiguous slice
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    for (unsigned w = 0; w < workers; ++w) {
+        queues.emplace_back(new WorkQueue);
+        size_t first = jobs.size() * w / workers;
+        size_t last = jobs.size() * (w + 1) / workers;
+        for (size_t i = first; i < last; ++i) {
+            queues[w]->jobs.push_back(i);
+        }
+    }
+
+    auto worker = [&](unsigned self) {
+        size_t job;
+        for (;;) {
+            bool found = queues[self]->pop_front(job);
+            for (unsigned k = 1; !found && k < workers; ++k) {
+                found = queues[(self + k) % workers]->steal_back(job);
+            }
+            if (!found) {
+                return; // Every queue is empty, and jobs never add jobs
+            }
+            results[job] = run_job(jobs[job]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned w = 1; w < workers; ++w) {
+        threads.emplace_back(worker, w);
+    }
+    worker(0);
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    return results;
+}
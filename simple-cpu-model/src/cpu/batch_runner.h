@@ -0,0 +1,55 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <cstdint>
+#include <vector>
+#include "common.h"
+#include "functional_core.h"
+
+// One independent program run: instruction memory, data memory loaded at
+// address 0, and an instruction budget.
+struct BatchJob {
+    std::vector<uint16_t> program;
+    std::vector<uint16_t> data;
+    uint64_t max_instructions = UINT64_MAX;
+};
+
+// Final architectural state of a BatchJob
+struct BatchResult {
+    FunctionalCore::StopReason stop_reason = FunctionalCore::RUNNING; // RUNNING: budget exhausted
+    uint64_t instructions = 0;
+    uint64_t unknown_opcodes = 0;
+    unsigned pc = 0;
+    uint16_t registers[NUM_REGISTERS] = {};
+    std::vector<uint16_t> memory; // Whole data memory, 1 << ADDR_SIZE words
+    bool data_truncated = false;  // job.data did not fit in data memory
+};
+
+// Runs many independent jobs on FunctionalCore across host threads, without
+// the SystemC kernel, which can only run one simulation per process. Every
+// job gets its own core; nothing is shared between workers except the job
+// queues. Each worker starts with an equal slice of the jobs and, once its
+// own queue is empty, steals from the far end of another worker's queue, so
+// a few long jobs do not leave the other threads idle.
+//
+// Unknown opcodes are counted instead of reported, since SC_REPORT_* is not
+// thread-safe.
+class BatchRunner {
+public:
+    // threads == 0 uses one worker per hardware thread
+    explicit BatchRunner(unsigned threads = 0);
+
+    unsigned threads() const { return thread_count; }
+
+    // Run every job to HALT, an out-of-bounds PC or its instruction budget.
+    // results[i] belongs to jobs[i].
+    std::vector<BatchResult> run(const std::vector<BatchJob>& jobs) const;
+
+    // Run a single job on the calling thread
+    static BatchResult run_job(const BatchJob& job);
+
+private:
+    unsigned thread_count;
+};
+
+#endif // BATCH_RUNNER_H
@@ -0,0 +1,86 @@
+#include "branch_predictor.h"
+#include <systemc.h>
+#include <algorithm>
+#include <iomanip>
+
+unsigned BranchPredictor::resolve(unsigned pc, unsigned target, unsigned snapshot, bool predicted, bool taken,
+                                  unsigned penalty) {
+    ++branches;
+    train(pc, target, taken, snapshot);
+    if (predicted == taken) {
+        return 0;
+    }
+    recover(snapshot, taken);
+    ++mispredictions;
+    penalty_cycles += penalty;
+    return penalty;
+}
+
+void BranchPredictor::reset_counters() {
+    branches = 0;
+    mispredictions = 0;
+    penalty_cycles = 0;
+}
+
+double BranchPredictor::accuracy() const {
+    return branches > 0 ? 1.0 - static_cast<double>(mispredictions) / branches : 1.0;
+}
+
+void BranchPredictor::dump(std::ostream& os) const {
+    os << "Branch predictor (" << name() << "): " << branches << " branches, " << mispredictions
+       << " mispredicted, accuracy " << std::fixed << std::setprecision(2) << 100.0 * accuracy() << "%" << std::endl;
+    os << "  Penalty cycles: " << penalty_cycles << std::endl;
+}
+
+BimodalPredictor::BimodalPredictor(unsigned table_bits) :
+    counters(size_t(1) << std::min(table_bits, 24u), 1), index_mask(static_cast<unsigned>(counters.size() - 1)) {}
+
+bool BimodalPredictor::predict(unsigned pc, unsigned) {
+    return counters[pc & index_mask] >= 2;
+}
+
+void BimodalPredictor::train(unsigned pc, unsigned, bool taken, unsigned) {
+    count(counters[pc & index_mask], taken);
+}
+
+void BimodalPredictor::count(uint8_t& counter, bool taken) {
+    if (taken && counter < 3) {
+        ++counter;
+    } else if (!taken && counter > 0) {
+        --counter;
+    }
+}
+
+GsharePredictor::GsharePredictor(unsigned table_bits, unsigned history_bits) :
+    BimodalPredictor(table_bits), history(0) {
+    // Longer history than index bits would never reach the table
+    history_mask = index_mask & ((1u << std::min(history_bits, 24u)) - 1);
+}
+
+bool GsharePredictor::predict(unsigned pc, unsigned) {
+    bool taken = counters[(pc ^ history) & index_mask] >= 2;
+    history = ((history << 1) | (taken ? 1 : 0)) & history_mask;
+    return taken;
+}
+
+void GsharePredictor::train(unsigned pc, unsigned, bool taken, unsigned snapshot) {
+    count(counters[(pc ^ snapshot) & index_mask], taken);
+}
+
+void GsharePredictor::recover(unsigned snapshot, bool taken) {
+    history = ((snapshot << 1) | (taken ? 1 : 0)) & history_mask;
+}
+
+std::unique_ptr<BranchPredictor> make_branch_predictor(const BranchPredictorConfig& config) {
+    switch (config.kind) {
+        case PREDICT_NOT_TAKEN:      return std::unique_ptr<BranchPredictor>(new StaticPredictor(false));
+        case PREDICT_BACKWARD_TAKEN: return std::unique_ptr<BranchPredictor>(new StaticPredictor(true));
+        case PREDICT_BIMODAL:        return std::unique_ptr<BranchPredictor>(new BimodalPredictor(config.table_bits));
+        case PREDICT_GSHARE:
+            if (config.history_bits > config.table_bits) {
+                SC_REPORT_WARNING("BranchPredictor", "Gshare history is longer than the table index; it is truncated.");
+            }
+            return std::unique_ptr<BranchPredictor>(new GsharePredictor(config.table_bits, config.history_bits));
+    }
+    return nullptr;
+}
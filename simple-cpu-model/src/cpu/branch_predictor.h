@@ -0,0 +1,112 @@
+#ifndef BRANCH_PREDICTOR_H
+#define BRANCH_PREDICTOR_H
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// Direction predictor for the conditional branches (BEQZ, BNEZ). Targets
+// need no prediction: they are in the predecoded program, which acts as a
+// branch target buffer that always hits, so JMP is never mispredicted.
+//
+// A model takes snapshot() and asks predict() when it fetches a branch,
+// and calls resolve() with both once the branch has executed, in program
+// order. Younger branches may be predicted before older ones resolve, as in
+// the pipeline: predict() may update state speculatively, and resolve()
+// repairs it after a misprediction. Subclass it to try other schemes (see
+// SimpleCPU::set_branch_predictor).
+class BranchPredictor {
+public:
+    // Counters since construction or reset_counters()
+    uint64_t branches;
+    uint64_t mispredictions;
+    uint64_t penalty_cycles; // As charged by the models through resolve()
+
+    BranchPredictor() : branches(0), mispredictions(0), penalty_cycles(0) {}
+    virtual ~BranchPredictor() {}
+
+    virtual const char* name() const = 0;
+    // State besides the PC that the next prediction depends on
+    virtual unsigned snapshot() const { return 0; }
+    virtual bool predict(unsigned pc, unsigned target) = 0;
+    // Learn the outcome of the branch at pc, predicted from snapshot
+    virtual void train(unsigned pc, unsigned target, bool taken, unsigned snapshot) = 0;
+    // The branch predicted from snapshot was mispredicted: drop what
+    // predict() assumed since, the branch having gone taken's way
+    virtual void recover(unsigned, bool) {}
+
+    // Count and train on a branch predicted as predicted from snapshot.
+    // Returns penalty if that was wrong, else 0.
+    unsigned resolve(unsigned pc, unsigned target, unsigned snapshot, bool predicted, bool taken, unsigned penalty);
+
+    void reset_counters();
+    double accuracy() const;
+    void dump(std::ostream& os) const;
+};
+
+// Not taken, or backward taken / forward not taken
+class StaticPredictor : public BranchPredictor {
+public:
+    explicit StaticPredictor(bool backward_taken) : backward_taken(backward_taken) {}
+
+    const char* name() const override { return backward_taken ? "backward taken" : "not taken"; }
+    bool predict(unsigned pc, unsigned target) override { return backward_taken && target <= pc; }
+    void train(unsigned, unsigned, bool, unsigned) override {}
+
+private:
+    bool backward_taken;
+};
+
+// Two-bit saturating counters indexed by the low table_bits of the PC
+class BimodalPredictor : public BranchPredictor {
+public:
+    explicit BimodalPredictor(unsigned table_bits = 10);
+
+    const char* name() const override { return "bimodal"; }
+    bool predict(unsigned pc, unsigned target) override;
+    void train(unsigned pc, unsigned target, bool taken, unsigned snapshot) override;
+
+protected:
+    std::vector<uint8_t> counters; // 0, 1 predict not taken; 2, 3 taken
+    unsigned index_mask;
+
+    static void count(uint8_t& counter, bool taken);
+};
+
+// Bimodal counters indexed by the PC xor the outcomes of the last
+// history_bits branches, so a branch can be predicted from the path to it.
+// Each prediction enters the history at once and a misprediction restores
+// it, so a branch sees the branches before it on its path even when they
+// have not resolved yet, and trains the counter it was predicted from.
+class GsharePredictor : public BimodalPredictor {
+public:
+    GsharePredictor(unsigned table_bits = 10, unsigned history_bits = 8);
+
+    const char* name() const override { return "gshare"; }
+    unsigned snapshot() const override { return history; }
+    bool predict(unsigned pc, unsigned target) override;
+    void train(unsigned pc, unsigned target, bool taken, unsigned snapshot) override;
+    void recover(unsigned snapshot, bool taken) override;
+
+private:
+    unsigned history;
+    unsigned history_mask;
+};
+
+enum BranchPredictorKind {
+    PREDICT_NOT_TAKEN,
+    PREDICT_BACKWARD_TAKEN,
+    PREDICT_BIMODAL,
+    PREDICT_GSHARE
+};
+
+struct BranchPredictorConfig {
+    BranchPredictorKind kind = PREDICT_BIMODAL;
+    unsigned table_bits = 10;  // Bimodal and gshare: 1 << table_bits counters
+    unsigned history_bits = 8; // Gshare only, at most table_bits
+};
+
+std::unique_ptr<BranchPredictor> make_branch_predictor(const BranchPredictorConfig& config);
+
+#endif // BRANCH_PREDICTOR_H
@@ -0,0 +1,42 @@
+#ifndef BYTE_ORDER_H
+#define BYTE_ORDER_H
+
+#include <cstdint>
+#include <vector>
+
+// Little-endian helpers for the on-disk formats (ProgramImage, Checkpoint)
+
+inline bool host_is_little_endian() {
+    const uint16_t probe = 1;
+    return *reinterpret_cast<const uint8_t*>(&probe) == 1;
+}
+
+inline uint16_t read_le16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t read_le32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint64_t read_le64(const uint8_t* p) {
+    return read_le32(p) | (static_cast<uint64_t>(read_le32(p + 4)) << 32);
+}
+
+inline void write_le16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(v & 0xFF);
+    out.push_back(v >> 8);
+}
+
+inline void write_le32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back((v >> (8 * i)) & 0xFF);
+    }
+}
+
+inline void write_le64(std::vector<uint8_t>& out, uint64_t v) {
+    write_le32(out, static_cast<uint32_t>(v));
+    write_le32(out, static_cast<uint32_t>(v >> 32));
+}
+
+#endif // BYTE_ORDER_H
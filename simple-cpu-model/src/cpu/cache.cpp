@@ -0,0 +1,143 @@
+#include "cache.h"
+#include <systemc.h>
+#include <iomanip>
+
+static bool is_power_of_two(unsigned n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+static unsigned log2_of(unsigned n) {
+    unsigned bits = 0;
+    while ((1u << bits) < n) {
+        ++bits;
+    }
+    return bits;
+}
+
+bool CacheConfig::valid() const {
+    return is_power_of_two(size_words) && is_power_of_two(line_words) && is_power_of_two(ways) &&
+           size_words >= line_words * ways;
+}
+
+Cache::Cache(const CacheConfig& requested) :
+    config(requested.valid() ? requested : CacheConfig()) {
+    if (!requested.valid()) {
+        SC_REPORT_WARNING("Cache", "Cache sizes must be powers of two with room for every way; using the default geometry.");
+    }
+    line_shift = log2_of(config.line_words);
+    set_mask = config.size_words / config.line_words / config.ways - 1;
+    lines.resize(config.size_words / config.line_words);
+    clear();
+}
+
+void Cache::clear() {
+    for (Line& line : lines) {
+        line = Line{ 0, 0, false, false };
+    }
+    reset_counters();
+    tick = 0;
+    random_state = 0x9E3779B9u;
+}
+
+void Cache::reset_counters() {
+    reads = read_misses = 0;
+    writes = write_misses = 0;
+    evictions = writebacks = memory_writes = 0;
+    penalty_cycles = 0;
+}
+
+Cache::Line& Cache::victim(Line* set) {
+    for (unsigned w = 0; w < config.ways; ++w) {
+        if (!set[w].valid) {
+            return set[w];
+        }
+    }
+    if (config.replacement == CACHE_RANDOM) {
+        // xorshift32, so runs are reproducible
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 17;
+        random_state ^= random_state << 5;
+        return set[random_state & (config.ways - 1)];
+    }
+    // LRU and FIFO differ only in when stamp is updated
+    Line* oldest = set;
+    for (unsigned w = 1; w < config.ways; ++w) {
+        if (set[w].stamp < oldest->stamp) {
+            oldest = &set[w];
+        }
+    }
+    return *oldest;
+}
+
+unsigned Cache::charge(unsigned cycles) {
+    penalty_cycles += cycles;
+    return config.timed ? cycles : 0;
+}
+
+unsigned Cache::access(uint64_t addr, bool write) {
+    ++tick;
+    if (write) {
+        ++writes;
+    } else {
+        ++reads;
+    }
+    uint64_t tag = addr >> line_shift;
+    Line* set = &lines[(tag & set_mask) * config.ways];
+    bool write_through = config.write_policy == CACHE_WRITE_THROUGH;
+
+    for (unsigned w = 0; w < config.ways; ++w) {
+        Line& line = set[w];
+        if (line.valid && line.tag == tag) {
+            if (config.replacement == CACHE_LRU) {
+                line.stamp = tick;
+            }
+            if (write && write_through) {
+                ++memory_writes;
+                return charge(config.memory_write_cycles);
+            }
+            line.dirty = line.dirty || write;
+            return charge(0);
+        }
+    }
+
+    if (write) {
+        ++write_misses;
+    } else {
+        ++read_misses;
+    }
+    if (write && write_through) {
+        ++memory_writes;
+        return charge(config.memory_write_cycles);
+    }
+
+    unsigned cycles = config.miss_cycles;
+    Line& line = victim(set);
+    if (line.valid) {
+        ++evictions;
+        if (line.dirty) {
+            ++writebacks;
+            cycles += config.memory_write_cycles;
+        }
+    }
+    line = Line{ tag, tick, true, write };
+    return charge(cycles);
+}
+
+double Cache::miss_rate() const {
+    uint64_t accesses = reads + writes;
+    return accesses > 0 ? static_cast<double>(misses()) / accesses : 0.0;
+}
+
+void Cache::dump(std::ostream& os) const {
+    static const char* replacement_names[] = { "LRU", "FIFO", "random" };
+    os << "Data cache: " << config.size_words << " words, " << config.ways << "-way, "
+       << config.line_words << "-word lines, " << replacement_names[config.replacement] << ", "
+       << (config.write_policy == CACHE_WRITE_BACK ? "write-back" : "write-through")
+       << (config.timed ? "" : ", stats only") << std::endl;
+    os << "  Reads: " << reads << " (" << read_misses << " misses), writes: " << writes
+       << " (" << write_misses << " misses), miss rate " << std::fixed << std::setprecision(2)
+       << 100.0 * miss_rate() << "%" << std::endl;
+    os << "  Evictions: " << evictions << " (" << writebacks << " written back), words written through: "
+       << memory_writes << std::endl;
+    os << "  Penalty cycles: " << penalty_cycles << std::endl;
+}
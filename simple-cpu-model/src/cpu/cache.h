@@ -0,0 +1,85 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+enum CacheReplacement {
+    CACHE_LRU,
+    CACHE_FIFO,
+    CACHE_RANDOM
+};
+
+enum CacheWritePolicy {
+    CACHE_WRITE_BACK,   // Write-allocate; dirty lines are written back on eviction
+    CACHE_WRITE_THROUGH // No write-allocate; every write also goes to memory
+};
+
+// Geometry and timing of a Cache. Sizes are in words and must be powers of
+// two, with size_words at least line_words * ways.
+struct CacheConfig {
+    unsigned size_words = 1024;
+    unsigned line_words = 8;
+    unsigned ways = 2;
+    CacheReplacement replacement = CACHE_LRU;
+    CacheWritePolicy write_policy = CACHE_WRITE_BACK;
+    unsigned miss_cycles = 20;         // Filling a line
+    unsigned memory_write_cycles = 20; // Writing a dirty line back, or one word through
+    bool timed = true;                 // False: count only, access() always returns 0
+
+    bool valid() const;
+};
+
+// Set-associative data cache model in front of DataMemory. It keeps tags and
+// dirty bits only: the data itself always stays in DataMemory, so the cache
+// decides how long an access takes but never what it returns, and turning it
+// on or off cannot change the results of a program. SimpleCPU calls access()
+// for every LOAD and STORE (see SimpleCPU::enable_data_cache).
+class Cache {
+public:
+    const CacheConfig config;
+
+    // Counters since construction or clear()
+    uint64_t reads, read_misses;
+    uint64_t writes, write_misses;
+    uint64_t evictions;      // Valid lines replaced
+    uint64_t writebacks;     // Dirty lines written back
+    uint64_t memory_writes;  // Words written through
+    uint64_t penalty_cycles; // Cycles of all misses and memory writes, also when not timed
+
+    // An invalid config is warned about and replaced by the default one
+    explicit Cache(const CacheConfig& config);
+
+    // Look up the line holding word addr and update tags, replacement state
+    // and counters. Returns the cycles the access takes beyond a hit.
+    unsigned access(uint64_t addr, bool write);
+
+    // Invalidate every line and reset the counters
+    void clear();
+    // Reset the counters only, keeping the lines, e.g. after warming up
+    void reset_counters();
+
+    uint64_t misses() const { return read_misses + write_misses; }
+    double miss_rate() const;
+    void dump(std::ostream& os) const;
+
+private:
+    struct Line {
+        uint64_t tag; // Line address, addr / line_words
+        uint64_t stamp; // Last use (LRU) or fill (FIFO)
+        bool valid;
+        bool dirty;
+    };
+
+    std::vector<Line> lines; // sets * ways, one set after the other
+    unsigned line_shift;
+    uint64_t set_mask;
+    uint64_t tick;
+    uint32_t random_state;
+
+    Line& victim(Line* set);
+    unsigned charge(unsigned cycles);
+};
+
+#endif // CACHE_H
@@ -0,0 +1,207 @@
+#include "checkpoint.h"
+#include "byte_order.h"
+#include "paged_memory.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+static const uint16_t VERSION = 1;
+static const uint16_t FLAG_COMPRESSED = 1;
+static const uint16_t ZERO_RUN = 0x8000;
+static const uint16_t MAX_RUN = 0x7FFF;
+
+static uint64_t resolution_fs() {
+    return static_cast<uint64_t>(std::llround(sc_get_time_resolution().to_seconds() * 1e15));
+}
+
+// Zero runs and literal runs, see checkpoint.h
+static void compress_page(const std::vector<uint16_t>& words, std::vector<uint16_t>& out) {
+    size_t i = 0;
+    while (i < words.size()) {
+        size_t start = i;
+        if (words[i] == 0) {
+            while (i < words.size() && words[i] == 0 && i - start < MAX_RUN) {
+                ++i;
+            }
+            out.push_back(static_cast<uint16_t>(ZERO_RUN | (i - start)));
+        } else {
+            // A single zero between literals is cheaper kept as a literal
+            while (i < words.size() && i - start < MAX_RUN &&
+                   (words[i] != 0 || (i + 1 < words.size() && words[i + 1] != 0))) {
+                ++i;
+            }
+            out.push_back(static_cast<uint16_t>(i - start));
+            out.insert(out.end(), words.begin() + start, words.begin() + i);
+        }
+    }
+}
+
+static bool decompress_page(const uint8_t* p, size_t count, std::vector<uint16_t>& words) {
+    words.clear();
+    size_t i = 0;
+    while (i < count) {
+        uint16_t run = read_le16(p + 2 * i++);
+        if (run & ZERO_RUN) {
+            words.insert(words.end(), run & MAX_RUN, 0);
+        } else {
+            if (run > count - i) {
+                return false;
+            }
+            for (unsigned k = 0; k < run; ++k) {
+                words.push_back(read_le16(p + 2 * i++));
+            }
+        }
+        if (words.size() > PagedMemory::PAGE_WORDS) {
+            return false;
+        }
+    }
+    return words.size() == PagedMemory::PAGE_WORDS;
+}
+
+Checkpoint::Checkpoint() : pc(0), instructions(0), time(SC_ZERO_TIME) {
+    for (int i = 0; i < NUM_REGISTERS; ++i) {
+        registers[i] = 0;
+    }
+}
+
+bool Checkpoint::save(const std::string& path, bool compress) const {
+    std::vector<uint8_t> out;
+    out.insert(out.end(), { 'S', 'C', 'C', 'K' });
+    write_le16(out, VERSION);
+    write_le16(out, compress ? FLAG_COMPRESSED : 0);
+    write_le16(out, ADDR_SIZE);
+    write_le16(out, DATA_ADDR_SIZE);
+    write_le64(out, instructions);
+    write_le64(out, time.value() * resolution_fs());
+    for (int i = 0; i < NUM_REGISTERS; ++i) {
+        write_le16(out, registers[i]);
+    }
+    write_le32(out, pc);
+    write_le32(out, program.size());
+    for (uint16_t w : program) {
+        write_le16(out, w);
+    }
+
+    write_le32(out, PagedMemory::PAGE_WORDS);
+    write_le64(out, data_pages.size());
+    std::vector<uint16_t> encoded;
+    for (const Page& page : data_pages) {
+        encoded.clear();
+        if (compress) {
+            compress_page(page.words, encoded);
+        } else {
+            encoded = page.words;
+        }
+        write_le64(out, page.index);
+        write_le32(out, encoded.size());
+        for (uint16_t w : encoded) {
+            write_le16(out, w);
+        }
+    }
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (f == nullptr) {
+        SC_REPORT_ERROR("Checkpoint", ("Cannot create " + path).c_str());
+        return false;
+    }
+    bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+    ok = std::fclose(f) == 0 && ok;
+    return ok;
+}
+
+bool Checkpoint::load(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (f == nullptr) {
+        SC_REPORT_ERROR("Checkpoint", ("Cannot open " + path).c_str());
+        return false;
+    }
+    std::vector<uint8_t> in;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) {
+        in.insert(in.end(), buf, buf + n);
+    }
+    std::fclose(f);
+
+    // Every read goes through need(), so a truncated file fails cleanly
+    size_t pos = 0;
+    auto need = [&](size_t bytes) { return bytes <= in.size() - pos; };
+    const std::string bad = "Bad checkpoint " + path;
+
+    if (!need(16) || std::memcmp(in.data(), "SCCK", 4) != 0 || read_le16(&in[4]) != VERSION) {
+        SC_REPORT_ERROR("Checkpoint", bad.c_str());
+        return false;
+    }
+    bool compressed = read_le16(&in[6]) & FLAG_COMPRESSED;
+    if (read_le16(&in[8]) != ADDR_SIZE || read_le16(&in[10]) != DATA_ADDR_SIZE) {
+        SC_REPORT_ERROR("Checkpoint", ("Checkpoint " + path + " was taken with different address sizes").c_str());
+        return false;
+    }
+    pos = 12;
+
+    if (!need(16 + 2 * NUM_REGISTERS + 8)) {
+        SC_REPORT_ERROR("Checkpoint", bad.c_str());
+        return false;
+    }
+    instructions = read_le64(&in[pos]);
+    uint64_t fs = read_le64(&in[pos + 8]);
+    time = sc_get_time_resolution() * static_cast<double>(fs / resolution_fs());
+    pos += 16;
+    for (int i = 0; i < NUM_REGISTERS; ++i, pos += 2) {
+        registers[i] = read_le16(&in[pos]);
+    }
+    pc = read_le32(&in[pos]);
+    if (pc > ADDR_MASK) {
+        SC_REPORT_ERROR("Checkpoint", bad.c_str());
+        return false;
+    }
+    uint32_t program_words = read_le32(&in[pos + 4]);
+    pos += 8;
+    if (!need(2 * static_cast<size_t>(program_words) + 12)) {
+        SC_REPORT_ERROR("Checkpoint", bad.c_str());
+        return false;
+    }
+    program.resize(program_words);
+    for (uint32_t i = 0; i < program_words; ++i, pos += 2) {
+        program[i] = read_le16(&in[pos]);
+    }
+
+    uint32_t page_words = read_le32(&in[pos]);
+    uint64_t page_count = read_le64(&in[pos + 4]);
+    pos += 12;
+    if (page_words != PagedMemory::PAGE_WORDS) {
+        SC_REPORT_ERROR("Checkpoint", ("Checkpoint " + path + " uses a different page size").c_str());
+        return false;
+    }
+    data_pages.clear();
+    for (uint64_t p = 0; p < page_count; ++p) {
+        if (!need(12)) {
+            SC_REPORT_ERROR("Checkpoint", bad.c_str());
+            return false;
+        }
+        Page page;
+        page.index = read_le64(&in[pos]);
+        uint32_t count = read_le32(&in[pos + 8]);
+        pos += 12;
+        if (!need(2 * static_cast<size_t>(count))) {
+            SC_REPORT_ERROR("Checkpoint", bad.c_str());
+            return false;
+        }
+        bool ok;
+        if (compressed) {
+            ok = decompress_page(&in[pos], count, page.words);
+        } else {
+            ok = count == PagedMemory::PAGE_WORDS;
+            for (uint32_t i = 0; ok && i < count; ++i) {
+                page.words.push_back(read_le16(&in[pos + 2 * i]));
+            }
+        }
+        if (!ok) {
+            SC_REPORT_ERROR("Checkpoint", bad.c_str());
+            return false;
+        }
+        pos += 2 * static_cast<size_t>(count);
+        data_pages.push_back(std::move(page));
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <systemc.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "common.h"
+
+// Architectural state of a SimpleCPU between two instructions: the program,
+// registers, the address of the next instruction, the non-zero pages of
+// data memory, and how many instructions and how much simulated time it
+// took to get there. SimpleCPU::checkpoint() takes one after sc_start
+// returns and SimpleCPU::restore() loads it into a freshly elaborated CPU,
+// so a long warm-up only has to be simulated once.
+//
+// The file format is little-endian: "SCCK", uint16 version (1), uint16
+// flags (bit 0: pages are compressed), uint16 ADDR_SIZE, uint16
+// DATA_ADDR_SIZE, uint64 instructions, uint64 time in femtoseconds, uint16
+// registers[NUM_REGISTERS], uint32 pc, uint32 program length followed by the
+// program words, uint32 words per page, uint64 page count, and per page a
+// uint64 page index, a uint32 length in words and the page words.
+// Compressed pages are a sequence of uint16 runs: 0x8000 | n stands for n
+// zero words, otherwise n literal words follow.
+struct Checkpoint {
+    struct Page {
+        uint64_t index;              // Address / PagedMemory::PAGE_WORDS
+        std::vector<uint16_t> words; // PagedMemory::PAGE_WORDS words
+    };
+
+    std::vector<uint16_t> program;
+    std::vector<Page> data_pages; // Pages not listed are all zero
+    uint16_t registers[NUM_REGISTERS];
+    unsigned pc;                  // Next instruction to execute
+    uint64_t instructions;        // Retired since reset
+    sc_time time;                 // Simulated time since reset
+
+    Checkpoint();
+
+    bool save(const std::string& path, bool compress = true) const;
+    bool load(const std::string& path);
+};
+
+#endif // CHECKPOINT_H
@@ -1,14 +1,96 @@
 #ifndef COMMON_H
 #define COMMON_H
 #include <systemc.h>
-// Define word size and address size
-const int WORD_SIZE = 16;
-const int ADDR_SIZE = 8;
-const int NUM_REGISTERS = 8;
+#include <cstdint>
+#include <type_traits>
+// Widths of the CPU. ADDR_SIZE is the width of the PC and of instruction
+// memory, which is dense. DATA_ADDR_SIZE is the width of data memory in
+// words, which is sparse (see PagedMemory) and can be much wider.
+// Instructions are always 16 bits; WORD_SIZE is the width of registers and
+// data words. Everything is constexpr, so masks and register bounds fold
+// away, and code templated on a CpuConfig (see BasicFunctionalCore) can run
+// several configurations in one binary.
+template <int WordBits, int AddrBits, int DataAddrBits = AddrBits, int Registers = 8>
+struct CpuConfig {
+    static_assert(WordBits == 8 || WordBits == 16 || WordBits == 32, "WORD_SIZE must be 8, 16 or 32");
+    static_assert(AddrBits >= 6 && AddrBits <= 16, "ADDR_SIZE must be between 6 and 16");
+    static_assert(DataAddrBits >= 6 && DataAddrBits <= 32, "DATA_ADDR_SIZE must be between 6 and 32");
+    static_assert(Registers == 2 || Registers == 4 || Registers == 8,
+                  "NUM_REGISTERS must be 2, 4 or 8; register fields are 3 bits");
+
+    static constexpr int WORD_SIZE = WordBits;
+    static constexpr int ADDR_SIZE = AddrBits;
+    static constexpr int DATA_ADDR_SIZE = DataAddrBits;
+    static constexpr int NUM_REGISTERS = Registers;
+
+    // Masks for keeping native integers within WORD_SIZE / ADDR_SIZE /
+    // DATA_ADDR_SIZE bits
+    static constexpr unsigned WORD_MASK = WordBits == 32 ? 0xFFFFFFFFu : (1u << WordBits) - 1;
+    static constexpr unsigned ADDR_MASK = (1u << AddrBits) - 1;
+    static constexpr uint64_t DATA_ADDR_MASK = (uint64_t(1) << DataAddrBits) - 1;
+
+    // Smallest native integer that holds a data word
+    typedef typename std::conditional<WordBits == 8, uint8_t,
+            typename std::conditional<WordBits == 16, uint16_t, uint32_t>::type>::type native_word;
+
+    typedef sc_uint<WordBits> word;
+    typedef sc_uint<AddrBits> address;
+
+    // A register field of an instruction, wrapped to NUM_REGISTERS
+    static unsigned register_index(unsigned field) {
+        return Registers == 8 ? field : field & (Registers - 1);
+    }
+};
+
+// Address widths of the default configuration are set with the CMake
+// options SIMPLE_CPU_ADDR_SIZE and SIMPLE_CPU_DATA_ADDR_SIZE.
+#ifndef SIMPLE_CPU_ADDR_SIZE
+#define SIMPLE_CPU_ADDR_SIZE 8
+#endif
+#ifndef SIMPLE_CPU_DATA_ADDR_SIZE
+#define SIMPLE_CPU_DATA_ADDR_SIZE SIMPLE_CPU_ADDR_SIZE
+#endif
+
+// The configuration of SimpleCPU and its modules, whose ports, memories
+// and file formats are 16 bits wide
+typedef CpuConfig<16, SIMPLE_CPU_ADDR_SIZE, SIMPLE_CPU_DATA_ADDR_SIZE> DefaultCpuConfig;
+
+// Variants with 8 and 32-bit data words for design-space sweeps. Only
+// BasicFunctionalCore runs them, standalone and without a bus.
+typedef CpuConfig<8, SIMPLE_CPU_ADDR_SIZE, SIMPLE_CPU_DATA_ADDR_SIZE> Word8CpuConfig;
+typedef DefaultCpuConfig Word16CpuConfig;
+typedef CpuConfig<32, SIMPLE_CPU_ADDR_SIZE, SIMPLE_CPU_DATA_ADDR_SIZE> Word32CpuConfig;
+
+constexpr int WORD_SIZE = DefaultCpuConfig::WORD_SIZE;
+constexpr int ADDR_SIZE = DefaultCpuConfig::ADDR_SIZE;
+constexpr int DATA_ADDR_SIZE = DefaultCpuConfig::DATA_ADDR_SIZE;
+constexpr int NUM_REGISTERS = DefaultCpuConfig::NUM_REGISTERS;
 
 // Define basic data types
-typedef sc_uint<WORD_SIZE> word;
-typedef sc_uint<ADDR_SIZE> address;
+typedef DefaultCpuConfig::word word;
+typedef DefaultCpuConfig::address address;
+
+constexpr unsigned WORD_MASK = DefaultCpuConfig::WORD_MASK;
+constexpr unsigned ADDR_MASK = DefaultCpuConfig::ADDR_MASK;
+constexpr uint64_t DATA_ADDR_MASK = DefaultCpuConfig::DATA_ADDR_MASK;
+
+// Type used for values held inside the modules (register contents, ALU
+// arithmetic). Ports always use the SystemC types above. By default this is
+// a native integer and every value is masked explicitly; define
+// SIMPLE_CPU_SC_STATE (CMake option of the same name) to keep sc_uint, e.g.
+// to measure the difference. The memories always store uint16_t, since
+// their TLM sockets hand out DMI pointers to them. Like the ports, this is
+// DefaultCpuConfig's width: the SystemC modules are not templated on a
+// CpuConfig.
+#ifdef SIMPLE_CPU_SC_STATE
+typedef word state_word;
+#else
+typedef uint16_t state_word;
+#endif
+
+inline state_word mask_word(unsigned value) {
+    return static_cast<state_word>(value & WORD_MASK);
+}
 
 // Define some basic opcodes (for simplicity)
 enum Opcode {
@@ -16,6 +98,10 @@ enum Opcode {
     STORE = 2,
     ADD = 3,
     SUB = 4,
+    WFI = 5,  // Wait until the interrupt line is high, then continue
+    BEQZ = 6, // Branch by the signed immediate if rs1 is zero
+    BNEZ = 7, // Branch by the signed immediate if rs1 is not zero
+    JMP = 8,  // Jump by the signed 12-bit offset in bits [11:0]
     HALT = 0
 };
 #endif // COMMON_H
\ No newline at end of file
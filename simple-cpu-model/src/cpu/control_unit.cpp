@@ -1,57 +1,104 @@
 #include "control_unit.h"
+#include "sim_stats.h"
 
-void ControlUnit::decode() {
-    Opcode opcode = static_cast<Opcode>((instruction_in.read().range(15, 12)).to_uint());
-    sc_uint<3> rd = instruction_in.read().range(11, 9);
-    sc_uint<3> rs1 = instruction_in.read().range(8, 6);
-    word immediate = instruction_in.read().range(5, 0);
-    sc_uint<3> rs2 = immediate.range(5, 3); // Using upper bits for second register in ALU ops
-
-    pc_enable.write(true); // Usually increment PC
-
-    mem_read_enable.write(false);
-    mem_write_enable.write(false);
+ControlSignals ControlUnit::control_for(const DecodedInstruction& insn) {
+    ControlSignals c;
+    c.pc_enable = true; // Usually increment PC
+    c.mem_read = false;
+    c.mem_write = false;
+    c.reg_write = false;
+    c.reads_rs1 = false;
+    c.reads_rs2 = false;
+    c.alu_control = 0; // Default to ADD
+    c.halt = false;
+    c.wait_for_interrupt = false;
+    c.branch = BRANCH_NEVER;
+    c.known = true;
 
-    reg_write_enable.write(false);
-
-    alu_control.write(0); // Default to ADD
-
-    switch (opcode) {
+    switch (static_cast<Opcode>(insn.opcode)) {
         case LOAD:
-            mem_read_enable.write(true);
-            mem_addr.write(immediate); // Address from immediate field
-            reg_write_enable.write(true);
-            reg_write_addr.write(rd);
+            c.mem_read = true;
+            c.reg_write = true;
             break;
         case STORE:
-            mem_write_enable.write(true);
-            mem_addr.write(immediate); // Address from immediate field
-            mem_write_data.write(/* Need data from a register */ 0); // Will be connected later
+            c.mem_write = true;
+            c.reads_rs1 = true; // Value to store
             break;
         case ADD:
-            alu_control.write(0);
-            alu_operand1.write(/* Need data from rs1 */ 0); // Will be connected later
-            alu_operand2.write(/* Need data from rs2 */ 0); // Will be connected later
-            reg_write_enable.write(true);
-            reg_write_addr.write(rd);
+            c.alu_control = 0;
+            c.reg_write = true;
+            c.reads_rs1 = true;
+            c.reads_rs2 = true;
             break;
         case SUB:
-            alu_control.write(1);
-            alu_operand1.write(/* Need data from rs1 */ 0); // Will be connected later
-            alu_operand2.write(/* Need data from rs2 */ 0); // Will be connected later
-            reg_write_enable.write(true);
-            reg_write_addr.write(rd);
+            c.alu_control = 1;
+            c.reg_write = true;
+            c.reads_rs1 = true;
+            c.reads_rs2 = true;
             break;
         case HALT:
-            SC_REPORT_INFO("ControlUnit", "HALT instruction encountered. Stopping simulation.");
-            sc_stop();
+            c.halt = true;
+            break;
+        case WFI:
+            c.wait_for_interrupt = true;
+            break;
+        case BEQZ:
+            c.branch = BRANCH_IF_ZERO;
+            c.reads_rs1 = true;
+            break;
+        case BNEZ:
+            c.branch = BRANCH_IF_NONZERO;
+            c.reads_rs1 = true;
+            break;
+        case JMP:
+            c.branch = BRANCH_ALWAYS;
             break;
         default:
-            SC_REPORT_WARNING("ControlUnit", ("Unknown opcode: " + sc_uint<4>(opcode).to_string(SC_BIN)).c_str());
+            c.known = false;
             break;
     }
+    return c;
+}
+
+void ControlUnit::decode() {
+    ++SimStats::process_activations;
+    ++instructions_decoded;
+
+    // Fields were sliced once by InstructionMemory::load_program
+    const DecodedInstruction& insn = instruction_in.read();
+    if (profiler) {
+        profiler->count_instruction(insn);
+    }
+    ControlSignals c = control_for(insn);
+
+    pc_enable.write(c.pc_enable);
+    mem_read_enable.write(c.mem_read);
+    mem_write_enable.write(c.mem_write);
+    reg_write_enable.write(c.reg_write);
+    alu_control.write(c.alu_control);
+    wait_for_interrupt.write(c.wait_for_interrupt);
+    if (c.mem_read || c.mem_write) {
+        mem_addr.write(insn.immediate); // Address from immediate field
+    }
+    if (c.reg_write) {
+        reg_write_addr.write(insn.rd);
+    }
+
+    if (c.halt) {
+        SC_REPORT_INFO("ControlUnit", "HALT instruction encountered. Stopping simulation.");
+        sc_stop();
+    } else if (!c.known) {
+        SC_REPORT_WARNING("ControlUnit", ("Unknown opcode: " + sc_uint<4>(insn.opcode).to_string(SC_BIN)).c_str());
+    }
+
+    reg_read1_addr.write(insn.rs1);
+    reg_read2_addr.write(insn.rs2); // Using upper bits for second register in ALU ops
+    // Store data and ALU operands are driven by SimpleCPU::connect_data_paths
+}
 
-    reg_read1_addr.write(rs1);
-    reg_read2_addr.write(rs2);
-    // mem_write_data will be connected to a register's output
+void ControlUnit::resolve_branch() {
+    ++SimStats::process_activations;
+    const DecodedInstruction& insn = instruction_in.read();
+    branch_taken.write(takes_branch(control_for(insn).branch, branch_operand.read().to_uint()));
+    branch_target.write(insn.target);
 }
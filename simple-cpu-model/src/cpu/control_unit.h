@@ -3,29 +3,71 @@
 
 #include "systemc.h"
 #include "common.h"
+#include "decoder.h"
+#include "profiler.h"
+
+// When a control-flow instruction goes to its target, judged on rs1
+enum BranchCondition {
+    BRANCH_NEVER,      // Not a branch
+    BRANCH_IF_ZERO,    // BEQZ
+    BRANCH_IF_NONZERO, // BNEZ
+    BRANCH_ALWAYS      // JMP
+};
+
+// Control signals for one instruction, as driven by ControlUnit::decode
+struct ControlSignals {
+    bool pc_enable;
+    bool mem_read, mem_write;
+    bool reg_write;
+    bool reads_rs1, reads_rs2; // Source registers used, for hazard detection
+    unsigned alu_control; // 0 = ADD, 1 = SUB
+    bool halt;
+    bool wait_for_interrupt; // WFI
+    BranchCondition branch;
+    bool known;           // False for opcodes outside the ISA
+};
 
 SC_MODULE(ControlUnit) {
 public:
     // Input and output ports
 
-    sc_in<word> instruction_in;
+    sc_in<DecodedInstruction> instruction_in; // Predecoded by InstructionMemory
     sc_out<bool> pc_enable;
     sc_out<bool> mem_read_enable, mem_write_enable;
     sc_out<address> mem_addr;
-    sc_out<word> mem_write_data;
     sc_out<sc_uint<8>> reg_read1_addr, reg_read2_addr, reg_write_addr;
     //sc_out<word> reg_write_data_from_mem; // Data from memory to register
     sc_out<bool> reg_write_enable;
-    sc_out<word> alu_operand1, alu_operand2;
     sc_out<sc_uint<8>> alu_control;
+    sc_out<bool> wait_for_interrupt; // To ProgramCounter
+    sc_in<word> branch_operand;      // rs1, from the register file
+    sc_out<bool> branch_taken;       // To ProgramCounter, with the target
+    sc_out<address> branch_target;
+
+    uint64_t instructions_decoded;
+    Profiler* profiler; // Optional, counts executions per PC and opcode
 
     // Constructor
-    SC_CTOR(ControlUnit) {
+    SC_CTOR(ControlUnit) : instructions_decoded(0), profiler(nullptr) {
         SC_METHOD(decode);
         sensitive << instruction_in; // Sensitive to changes in instruction input
+        dont_initialize(); // The default DecodedInstruction is a HALT
+
+        // The operand settles a few delta cycles after the instruction
+        SC_METHOD(resolve_branch);
+        sensitive << instruction_in << branch_operand;
+        dont_initialize();
     }
 
     void decode() ;    
+    void resolve_branch();
+
+    // The decode logic itself, shared with the levelized datapath
+    static ControlSignals control_for(const DecodedInstruction& insn);
+    static bool takes_branch(BranchCondition condition, unsigned rs1_value) {
+        return condition == BRANCH_ALWAYS || (condition == BRANCH_IF_ZERO && rs1_value == 0) ||
+               (condition == BRANCH_IF_NONZERO && rs1_value != 0);
+    }
 };
 
 #endif // CONTROL_UNIT_H
\ No newline at end of file
@@ -1,12 +1,164 @@
 #include "data_memory.h"
+#include "memory_transport.h"
+#include "mmio.h"
+#include "sim_stats.h"
+#include "trace_log.h"
 #include <systemc.h>
+#include <algorithm>
 
 void DataMemory::read_data() {
-    data_out.write(memory[addr_in.read()]);
+    ++SimStats::process_activations;
+    data_out.write(read_word(addr_in.read().to_uint64()));
 }
 void DataMemory::write_data() {
+    ++SimStats::process_activations;
     if (write_enable.read()) {
-        memory[addr_in.read()] = data_in.read();
-        SC_REPORT_INFO("DataMemory", ("Wrote " + data_in.read().to_string() + " to address " + addr_in.read().to_string()).c_str());
+        uint64_t addr = addr_in.read().to_uint64();
+        if (device_at(addr & DATA_ADDR_MASK)) {
+            pending_device_addr = addr;
+            pending_device_value = static_cast<uint16_t>(data_in.read().to_uint());
+            device_write_event.notify(sc_get_time_resolution());
+        } else {
+            write_word(addr, data_in.read().to_uint());
+        }
     }
-}
\ No newline at end of file
+}
+
+void DataMemory::commit_device_write() {
+    ++SimStats::process_activations;
+    write_word(pending_device_addr, pending_device_value);
+}
+
+uint16_t DataMemory::read_word(uint64_t addr) {
+    addr &= DATA_ADDR_MASK;
+    uint16_t value = read_untraced(addr);
+    TRACE_ACCESS(TRACE_DATA_MEMORY, TRACE_ACCESSES, false, addr, value);
+    return value;
+}
+
+void DataMemory::write_word(uint64_t addr, unsigned value) {
+    addr &= DATA_ADDR_MASK;
+    write_untraced(addr, static_cast<uint16_t>(value & WORD_MASK));
+    TRACE_ACCESS(TRACE_DATA_MEMORY, TRACE_WRITES, true, addr, value & WORD_MASK);
+}
+
+uint16_t DataMemory::read_untraced(uint64_t addr) {
+    const DeviceMapping* mapping = device_at(addr);
+    return mapping ? mapping->device->read(static_cast<unsigned>(addr - mapping->base)) : memory.read(addr);
+}
+
+void DataMemory::write_untraced(uint64_t addr, uint16_t value) {
+    const DeviceMapping* mapping = device_at(addr);
+    if (mapping) {
+        mapping->device->write(static_cast<unsigned>(addr - mapping->base), value);
+    } else {
+        memory.write(addr, value);
+    }
+}
+
+bool DataMemory::map_device(uint64_t base, MmioDevice& device) {
+    uint64_t words = device.words();
+    if (words == 0 || base >= memory.size() || words > memory.size() - base) {
+        SC_REPORT_ERROR("DataMemory", "Device does not fit in the address space.");
+        return false;
+    }
+    for (const DeviceMapping& other : devices) {
+        if (base < other.base + other.words && other.base < base + words) {
+            SC_REPORT_ERROR("DataMemory", "Device overlaps another device.");
+            return false;
+        }
+    }
+    devices.push_back({ base, words, &device });
+    devices_first = std::min(devices_first, base);
+    devices_last = std::max(devices_last, base + words - 1);
+    invalidate_dmi(base, base + words - 1);
+    return true;
+}
+
+const DataMemory::DeviceMapping* DataMemory::find_device(uint64_t addr) const {
+    for (const DeviceMapping& mapping : devices) {
+        if (addr >= mapping.base && addr < mapping.base + mapping.words) {
+            return &mapping;
+        }
+    }
+    return nullptr;
+}
+
+void DataMemory::load(const uint16_t* words, size_t count, uint64_t base) {
+    if (memory.copy_in(words, count, base) < count) {
+        SC_REPORT_WARNING("DataMemory", "Data image does not fit in memory; truncated.");
+    }
+}
+
+void DataMemory::map(uint16_t* words, size_t count, uint64_t base) {
+    if (memory.map(words, count, base) < count) {
+        SC_REPORT_WARNING("DataMemory", "Data image does not fit in memory; truncated.");
+    }
+    if (count > 0 && base < memory.size()) {
+        invalidate_dmi(base, std::min<uint64_t>(base + count, memory.size()) - 1);
+    }
+}
+
+void DataMemory::clear() {
+    memory.clear();
+    invalidate_dmi(0, memory.size() - 1);
+}
+
+void DataMemory::invalidate_dmi(uint64_t first, uint64_t last) {
+    if (socket.size() > 0) {
+        socket->invalidate_direct_mem_ptr(first * sizeof(uint16_t), last * sizeof(uint16_t) + 1);
+    }
+}
+
+void DataMemory::b_transport(tlm::tlm_generic_payload& trans, sc_time& delay) {
+    const DeviceMapping* mapping = device_at(trans.get_address() / sizeof(uint16_t));
+    if (mapping) {
+        transport_device(*mapping, trans);
+    } else {
+        transport_words(memory, trans, true);
+    }
+    delay += latency;
+}
+
+unsigned DataMemory::transport_dbg(tlm::tlm_generic_payload& trans) {
+    const DeviceMapping* mapping = device_at(trans.get_address() / sizeof(uint16_t));
+    return mapping ? transport_device(*mapping, trans) : transport_words(memory, trans, true);
+}
+
+// One aligned word at a time, so a device never sees a partial register
+unsigned DataMemory::transport_device(const DeviceMapping& mapping, tlm::tlm_generic_payload& trans) {
+    trans.set_dmi_allowed(false);
+    if (trans.get_data_length() != sizeof(uint16_t) || trans.get_address() % sizeof(uint16_t) != 0 ||
+        trans.get_byte_enable_ptr() != nullptr) {
+        trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
+        return 0;
+    }
+    unsigned offset = static_cast<unsigned>(trans.get_address() / sizeof(uint16_t) - mapping.base);
+    uint16_t* data = reinterpret_cast<uint16_t*>(trans.get_data_ptr());
+    if (trans.get_command() == tlm::TLM_READ_COMMAND) {
+        *data = mapping.device->read(offset);
+    } else if (trans.get_command() == tlm::TLM_WRITE_COMMAND) {
+        mapping.device->write(offset, *data);
+    }
+    trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    return sizeof(uint16_t);
+}
+
+bool DataMemory::get_direct_mem_ptr(tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi) {
+    uint64_t addr = trans.get_address();
+    if (device_at(addr / sizeof(uint16_t)) || !describe_dmi_region(memory, addr, dmi, true, latency)) {
+        return false;
+    }
+    // Cut the page down to the part around addr that no device overlaps
+    for (const DeviceMapping& mapping : devices) {
+        uint64_t first = mapping.base * sizeof(uint16_t);
+        uint64_t last = (mapping.base + mapping.words) * sizeof(uint16_t) - 1;
+        if (last < addr && last >= dmi.get_start_address()) {
+            dmi.set_dmi_ptr(dmi.get_dmi_ptr() + (last + 1 - dmi.get_start_address()));
+            dmi.set_start_address(last + 1);
+        } else if (first > addr && first <= dmi.get_end_address()) {
+            dmi.set_end_address(first - 1);
+        }
+    }
+    return true;
+}
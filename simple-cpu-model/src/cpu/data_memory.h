@@ -2,21 +2,81 @@
 #define DATA_MEMORY_H
 
 #include "systemc.h"
+#include <tlm.h>
+#include <tlm_utils/simple_target_socket.h>
+#include <cstdint>
+#include <vector>
 #include "common.h"
+#include "paged_memory.h"
+
+class MmioDevice;
 
 SC_MODULE(DataMemory) {
+    // Pin-level interface, used by the signal-level datapath
     sc_in<address> addr_in;
     sc_in<word> data_in;
     sc_in<bool> write_enable;
     sc_out<word> data_out;
 
-    std::vector<word> memory;
+    // Transaction-level interface. Addresses are in bytes, two per word.
+    // Binding it is optional.
+    tlm_utils::simple_target_socket_optional<DataMemory> socket;
+
+    // 1 << DATA_ADDR_SIZE words, of which only written pages take up host
+    // memory. Each page is plain words, so DMI is granted one page at a time.
+    PagedMemory memory;
+    sc_time latency; // Added to b_transport delays and reported for DMI
+
+    // Devices take over their words of the address space for every access
+    // path: the pins, read_word/write_word and the TLM socket. DMI is never
+    // granted over them.
+    struct DeviceMapping {
+        uint64_t base;
+        uint64_t words;
+        MmioDevice* device;
+    };
+    std::vector<DeviceMapping> devices;
 
     void read_data();
 
     void write_data();
 
-    SC_CTOR(DataMemory) : memory(1 << ADDR_SIZE, 0){
+    // Traced single-word access, as used by the processes above and the
+    // levelized datapath. addr wraps at DATA_ADDR_SIZE bits.
+    uint16_t read_word(uint64_t addr);
+    void write_word(uint64_t addr, unsigned value);
+    // The same without tracing, for the ISS modes
+    uint16_t read_untraced(uint64_t addr);
+    void write_untraced(uint64_t addr, uint16_t value);
+
+    // Map device at words [base, base + device.words()), before sc_start.
+    // Returns false if the range is outside memory or overlaps a device.
+    bool map_device(uint64_t base, MmioDevice& device);
+    const DeviceMapping* device_at(uint64_t addr) const {
+        return addr >= devices_first && addr <= devices_last ? find_device(addr) : nullptr;
+    }
+    // Lowest device address, or memory.size() without devices
+    uint64_t first_device_address() const { return devices.empty() ? memory.size() : devices_first; }
+
+    // Bulk copy of plain words to memory[base...], e.g. from a mapped
+    // ProgramImage segment. Words past the end of memory are dropped.
+    void load(const uint16_t* words, size_t count, uint64_t base = 0);
+
+    // Like load, but whole pages use words in place instead of a copy (see
+    // PagedMemory::map); words must stay valid until clear() or until the
+    // range is mapped again.
+    void map(uint16_t* words, size_t count, uint64_t base = 0);
+
+    // Back to all zeroes, releasing every page
+    void clear();
+
+    void b_transport(tlm::tlm_generic_payload& trans, sc_time& delay);
+    unsigned transport_dbg(tlm::tlm_generic_payload& trans);
+    bool get_direct_mem_ptr(tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi);
+
+    SC_CTOR(DataMemory) :
+        socket("socket"), memory(DATA_ADDR_SIZE), latency(SC_ZERO_TIME),
+        devices_first(UINT64_MAX), devices_last(0), pending_device_addr(0), pending_device_value(0) {
         SC_METHOD(read_data);
         sensitive << addr_in;
         dont_initialize();
@@ -24,8 +84,33 @@ SC_MODULE(DataMemory) {
         SC_METHOD(write_data);
         sensitive << addr_in << data_in << write_enable;
         dont_initialize();
+
+        SC_METHOD(commit_device_write);
+        sensitive << device_write_event;
+        dont_initialize();
+
+        socket.register_b_transport(this, &DataMemory::b_transport);
+        socket.register_transport_dbg(this, &DataMemory::transport_dbg);
+        socket.register_get_direct_mem_ptr(this, &DataMemory::get_direct_mem_ptr);
     }
+
+private:
+    uint64_t devices_first, devices_last; // Bounds of all devices, for a quick miss
+
+    // write_data sees a STORE's address and data settle over several delta
+    // cycles. Memory keeps the last value, but a device must see a single
+    // write, so the pins' device writes are committed once the time step
+    // has settled.
+    uint64_t pending_device_addr;
+    uint16_t pending_device_value;
+    sc_event device_write_event;
+
+    const DeviceMapping* find_device(uint64_t addr) const;
+    void commit_device_write();
+    unsigned transport_device(const DeviceMapping& mapping, tlm::tlm_generic_payload& trans);
+    // Tell initiators that DMI pointers into words [first, last] are stale
+    void invalidate_dmi(uint64_t first, uint64_t last);
 };
 
 
-#endif // DATA_MEMORY_H
\ No newline at end of file
+#endif // DATA_MEMORY_H
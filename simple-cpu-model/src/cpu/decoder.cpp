@@ -0,0 +1,36 @@
+#include "decoder.h"
+
+DecodedInstruction decode_instruction(uint16_t raw, unsigned addr, unsigned addr_size) {
+    const unsigned addr_mask = (1u << addr_size) - 1;
+    DecodedInstruction insn;
+    insn.raw = raw;
+    insn.opcode = (raw >> 12) & 0xF;
+    insn.rd = (raw >> 9) & 0x7;
+    insn.rs1 = (raw >> 6) & 0x7;
+    insn.immediate = raw & 0x3F;
+    insn.rs2 = (insn.immediate >> 3) & 0x7; // Using upper bits for second register in ALU ops
+    if (insn.opcode == BEQZ || insn.opcode == BNEZ) {
+        int offset = insn.immediate >= 32 ? insn.immediate - 64 : insn.immediate;
+        insn.target = static_cast<uint16_t>((addr + offset) & addr_mask);
+    } else if (insn.opcode == JMP) {
+        int offset = (raw & 0xFFF) >= 2048 ? (raw & 0xFFF) - 4096 : (raw & 0xFFF);
+        insn.target = static_cast<uint16_t>((addr + offset) & addr_mask);
+    }
+    insn.valid = true;
+    insn.addr = addr;
+    return insn;
+}
+
+void predecode_program(const std::vector<uint16_t>& program, std::vector<DecodedInstruction>& table,
+                       unsigned addr_size) {
+    const unsigned size = 1u << addr_size;
+    table.resize(size);
+    for (unsigned addr = 0; addr < size; ++addr) {
+        if (addr < program.size()) {
+            table[addr] = decode_instruction(program[addr], addr, addr_size);
+        } else {
+            table[addr] = DecodedInstruction();
+            table[addr].addr = addr;
+        }
+    }
+}
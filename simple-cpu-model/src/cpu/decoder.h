@@ -0,0 +1,77 @@
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <systemc.h>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "common.h"
+
+// An instruction word split into its fields once, at program load time.
+struct DecodedInstruction {
+    uint16_t raw;
+    uint8_t opcode;
+    uint8_t rd, rs1, rs2;
+    uint8_t immediate;
+    uint16_t target;    // Destination of a branch or jump, relative offsets already applied
+    bool valid;         // False past the end of the loaded program
+    unsigned addr;      // Where it was fetched from, so repeated words still change the signal
+
+    DecodedInstruction() :
+        raw(0), opcode(HALT), rd(0), rs1(0), rs2(0), immediate(0), target(0),
+        valid(false), addr(0) {}
+
+    bool operator==(const DecodedInstruction& other) const {
+        return raw == other.raw && addr == other.addr && valid == other.valid;
+    }
+};
+
+// Decode exactly as ControlUnit::decode used to slice the raw word:
+// opcode[15:12] rd[11:9] rs1[8:6] immediate[5:0], rs2 = immediate[5:3].
+// BEQZ and BNEZ branch to addr plus the sign-extended immediate, JMP to
+// addr plus the sign-extended offset[11:0], both wrapping at addr_size bits.
+DecodedInstruction decode_instruction(uint16_t raw, unsigned addr, unsigned addr_size = ADDR_SIZE);
+
+// Opcodes that can leave the PC anywhere but the next address
+inline bool is_branch(unsigned opcode) {
+    return opcode == BEQZ || opcode == BNEZ || opcode == JMP;
+}
+
+// Inverse of decode_instruction, for building programs in C++. For ADD and
+// SUB pass rs2 << 3 as the immediate, or use encode_alu.
+inline uint16_t encode_instruction(unsigned opcode, unsigned rd, unsigned rs1, unsigned immediate) {
+    return static_cast<uint16_t>(((opcode & 0xF) << 12) | ((rd & 0x7) << 9) | ((rs1 & 0x7) << 6) | (immediate & 0x3F));
+}
+
+inline uint16_t encode_alu(unsigned opcode, unsigned rd, unsigned rs1, unsigned rs2) {
+    return encode_instruction(opcode, rd, rs1, (rs2 & 0x7) << 3);
+}
+
+// BEQZ or BNEZ on rs1, offset in -32..31 relative to the branch itself
+inline uint16_t encode_branch(unsigned opcode, unsigned rs1, int offset) {
+    return encode_instruction(opcode, 0, rs1, static_cast<unsigned>(offset));
+}
+
+// Offset in -2048..2047 relative to the jump itself
+inline uint16_t encode_jump(int offset) {
+    return static_cast<uint16_t>((JMP << 12) | (static_cast<unsigned>(offset) & 0xFFF));
+}
+
+// Build the side table for a program. The table covers the whole address
+// space of addr_size bits, so lookups never need a bounds check; entries
+// past the end of the program are marked invalid.
+void predecode_program(const std::vector<uint16_t>& program, std::vector<DecodedInstruction>& table,
+                       unsigned addr_size = ADDR_SIZE);
+
+// Required for use in sc_signal
+inline std::ostream& operator<<(std::ostream& os, const DecodedInstruction& insn) {
+    os << "[" << insn.addr << "] 0x" << std::hex << insn.raw << std::dec;
+    return os;
+}
+
+inline void sc_trace(sc_trace_file* tf, const DecodedInstruction& insn, const std::string& name) {
+    sc_trace(tf, insn.raw, name + ".raw");
+    sc_trace(tf, insn.addr, name + ".addr");
+}
+
+#endif // DECODER_H
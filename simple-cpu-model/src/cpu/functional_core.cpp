@@ -0,0 +1,396 @@
+#include "functional_core.h"
+#include <string>
+
+template <class Config>
+static bool execute_load(BasicFunctionalCore<Config>& core, const DecodedInstruction& insn) {
+    core.reg(insn.rd) = core.read_data(insn.immediate);
+    return true;
+}
+
+template <class Config>
+static bool execute_store(BasicFunctionalCore<Config>& core, const DecodedInstruction& insn) {
+    core.write_data(insn.immediate, core.reg(insn.rs1));
+    return true;
+}
+
+// The native word is exactly WORD_SIZE bits wide, so the casts wrap
+template <class Config>
+static bool execute_add(BasicFunctionalCore<Config>& core, const DecodedInstruction& insn) {
+    typedef typename BasicFunctionalCore<Config>::data_word data_word;
+    core.reg(insn.rd) = static_cast<data_word>(core.reg(insn.rs1) + core.reg(insn.rs2));
+    return true;
+}
+
+template <class Config>
+static bool execute_sub(BasicFunctionalCore<Config>& core, const DecodedInstruction& insn) {
+    typedef typename BasicFunctionalCore<Config>::data_word data_word;
+    core.reg(insn.rd) = static_cast<data_word>(core.reg(insn.rs1) - core.reg(insn.rs2));
+    return true;
+}
+
+template <class Config>
+static bool execute_branch(BasicFunctionalCore<Config>& core, const DecodedInstruction& insn, bool taken) {
+    if (core.predictor) {
+        unsigned snapshot = core.predictor->snapshot();
+        bool predicted = core.predictor->predict(insn.addr, insn.target);
+        core.branch_stall_cycles +=
+            core.predictor->resolve(insn.addr, insn.target, snapshot, predicted, taken, core.branch_penalty);
+    }
+    if (taken) {
+        core.pc = insn.target; // Instead of the next address, which step() already set
+    }
+    return true;
+}
+
+template <class Config>
+static bool execute_beqz(BasicFunctionalCore<Config>& core, const DecodedInstruction& insn) {
+    return execute_branch(core, insn, core.reg(insn.rs1) == 0);
+}
+
+template <class Config>
+static bool execute_bnez(BasicFunctionalCore<Config>& core, const DecodedInstruction& insn) {
+    return execute_branch(core, insn, core.reg(insn.rs1) != 0);
+}
+
+template <class Config>
+static bool execute_jmp(BasicFunctionalCore<Config>& core, const DecodedInstruction& insn) {
+    core.pc = insn.target;
+    return true;
+}
+
+template <class Config>
+static bool execute_halt(BasicFunctionalCore<Config>& core, const DecodedInstruction&) {
+    ++core.instructions_executed;
+    core.stop_reason = FunctionalCoreBase::HALTED;
+    return false;
+}
+
+template <class Config>
+static bool execute_wfi(BasicFunctionalCore<Config>& core, const DecodedInstruction&) {
+    // The core has no interrupt line; whoever runs it waits for one
+    core.stop_reason = FunctionalCoreBase::WAITING_FOR_INTERRUPT;
+    return false;
+}
+
+template <class Config>
+static bool execute_unknown(BasicFunctionalCore<Config>& core, const DecodedInstruction& insn) {
+    ++core.unknown_opcodes;
+    if (core.report_unknown_opcodes) {
+        SC_REPORT_WARNING("FunctionalCore", ("Unknown opcode: " + sc_uint<4>(insn.opcode).to_string(SC_BIN)).c_str());
+    }
+    return true;
+}
+
+template <class Config>
+static bool execute_out_of_bounds(BasicFunctionalCore<Config>& core, const DecodedInstruction&) {
+    core.stop_reason = FunctionalCoreBase::PC_OUT_OF_BOUNDS;
+    return false;
+}
+
+template <class Config>
+typename BasicFunctionalCore<Config>::Handler BasicFunctionalCore<Config>::handler_for(const DecodedInstruction& insn) {
+    if (!insn.valid) {
+        return execute_out_of_bounds<Config>;
+    }
+    switch (insn.opcode) {
+        case LOAD:  return execute_load<Config>;
+        case STORE: return execute_store<Config>;
+        case ADD:   return execute_add<Config>;
+        case SUB:   return execute_sub<Config>;
+        case HALT:  return execute_halt<Config>;
+        case WFI:   return execute_wfi<Config>;
+        case BEQZ:  return execute_beqz<Config>;
+        case BNEZ:  return execute_bnez<Config>;
+        case JMP:   return execute_jmp<Config>;
+        default:    return execute_unknown<Config>;
+    }
+}
+
+template <class Config>
+BasicFunctionalCore<Config>::BasicFunctionalCore() :
+    memory(1 << Config::ADDR_SIZE, 0), data(nullptr), data_words(0), bus(nullptr), profiler(nullptr), predictor(nullptr), branch_penalty(2),
+    branch_stall_cycles(0), report_unknown_opcodes(true),
+    use_superblocks(true), superblock_translations(0), superblocks(1 << Config::ADDR_SIZE) {
+    load_program(program);
+    use_own_memory();
+    reset();
+}
+
+template <class Config>
+BasicFunctionalCore<Config>::BasicFunctionalCore(const BasicFunctionalCore& other) : data(nullptr), data_words(0) {
+    *this = other;
+}
+
+template <class Config>
+BasicFunctionalCore<Config>& BasicFunctionalCore<Config>::operator=(const BasicFunctionalCore& other) {
+    if (this == &other) {
+        return *this;
+    }
+    program = other.program;
+    decoded = other.decoded;
+    memory = other.memory;
+    bus = other.bus;
+    profiler = other.profiler;
+    predictor = other.predictor;
+    branch_penalty = other.branch_penalty;
+    branch_stall_cycles = other.branch_stall_cycles;
+    // A window into the other core's own memory becomes one into ours
+    if (other.data == other.memory.data()) {
+        use_own_memory();
+    } else {
+        attach_data(other.data, other.data_words);
+    }
+    for (int i = 0; i < Config::NUM_REGISTERS; ++i) {
+        registers[i] = other.registers[i];
+    }
+    pc = other.pc;
+    instructions_executed = other.instructions_executed;
+    unknown_opcodes = other.unknown_opcodes;
+    report_unknown_opcodes = other.report_unknown_opcodes;
+    use_superblocks = other.use_superblocks;
+    superblock_translations = other.superblock_translations;
+    superblocks = other.superblocks;
+    stop_reason = other.stop_reason;
+    return *this;
+}
+
+template <class Config>
+void BasicFunctionalCore<Config>::reset() {
+    for (int i = 0; i < Config::NUM_REGISTERS; ++i) {
+        registers[i] = 0;
+    }
+    pc = 0;
+    instructions_executed = 0;
+    unknown_opcodes = 0;
+    branch_stall_cycles = 0;
+    stop_reason = RUNNING;
+}
+
+template <class Config>
+void BasicFunctionalCore<Config>::load_program(const std::vector<uint16_t>& program) {
+    this->program = program;
+    std::vector<DecodedInstruction> table;
+    predecode_program(this->program, table, Config::ADDR_SIZE);
+    bind(table);
+    invalidate_superblocks();
+}
+
+template <class Config>
+void BasicFunctionalCore<Config>::load_program(const std::vector<uint16_t>& program, const std::vector<DecodedInstruction>& decoded) {
+    this->program = program;
+    bind(decoded);
+    invalidate_superblocks();
+}
+
+template <class Config>
+bool BasicFunctionalCore<Config>::write_program(unsigned addr, uint16_t value) {
+    if (addr >= program.size() || addr > Config::ADDR_MASK) {
+        SC_REPORT_ERROR("FunctionalCore", "Instruction address out of bounds!");
+        return false;
+    }
+    program[addr] = value;
+    decoded[addr].insn = decode_instruction(value, addr, Config::ADDR_SIZE);
+    decoded[addr].handler = handler_for(decoded[addr].insn);
+    invalidate_superblocks(addr);
+    return true;
+}
+
+template <class Config>
+FunctionalCoreBase::StopReason BasicFunctionalCore<Config>::step() {
+    // The table covers the whole address space, so no bounds check is needed
+    const BoundInstruction& op = decoded[pc];
+    if (profiler) {
+        profiler->count_instruction(op.insn);
+    }
+    // The PC is an ADDR_SIZE-bit register, just like ProgramCounter::pc.
+    // Branch handlers overwrite it; stopping leaves it on the instruction.
+    unsigned current = pc;
+    pc = (pc + 1) & Config::ADDR_MASK;
+    if (!op.handler(*this, op.insn)) {
+        pc = current;
+        return stop_reason;
+    }
+    ++instructions_executed;
+    return RUNNING;
+}
+
+template <class Config>
+void BasicFunctionalCore<Config>::complete_wait() {
+    if (stop_reason == WAITING_FOR_INTERRUPT) {
+        pc = (pc + 1) & Config::ADDR_MASK;
+        ++instructions_executed;
+        stop_reason = RUNNING;
+    }
+}
+
+template <class Config>
+void BasicFunctionalCore<Config>::attach_data(data_word* base, unsigned words) {
+    data = base;
+    if (words != data_words) {
+        // Blocks stop at the accesses that were outside the old window
+        data_words = words;
+        invalidate_superblocks();
+    }
+}
+
+template <class Config>
+void BasicFunctionalCore<Config>::use_own_memory() {
+    attach_data(memory.data(), memory.size());
+}
+
+// Only a DataBus is ever called: a NoDataBus pointer can only be null. A
+// configuration with a bus has 16-bit words, so nothing is truncated.
+static unsigned read_bus(DataBus* bus, unsigned addr) {
+    return bus->read(addr);
+}
+
+static unsigned read_bus(NoDataBus*, unsigned) {
+    return 0;
+}
+
+static void write_bus(DataBus* bus, unsigned addr, unsigned value) {
+    bus->write(addr, static_cast<uint16_t>(value));
+}
+
+static void write_bus(NoDataBus*, unsigned, unsigned) {}
+
+template <class Config>
+typename BasicFunctionalCore<Config>::data_word BasicFunctionalCore<Config>::bus_read(unsigned addr) {
+    if (bus == nullptr) {
+        SC_REPORT_ERROR("FunctionalCore", "Data address out of bounds!");
+        return 0;
+    }
+    return static_cast<data_word>(read_bus(bus, addr));
+}
+
+template <class Config>
+void BasicFunctionalCore<Config>::bus_write(unsigned addr, data_word value) {
+    if (bus == nullptr) {
+        SC_REPORT_ERROR("FunctionalCore", "Data address out of bounds!");
+        return;
+    }
+    write_bus(bus, addr, value);
+}
+
+template <class Config>
+bool BasicFunctionalCore<Config>::ends_superblock(const DecodedInstruction& insn) const {
+    if ((insn.opcode == LOAD || insn.opcode == STORE) && insn.immediate >= data_words) {
+        return true; // Reaches the bus, which may look at pc or the time
+    }
+    return !insn.valid || insn.opcode == HALT || insn.opcode == WFI;
+}
+
+template <class Config>
+void BasicFunctionalCore<Config>::bind(const std::vector<DecodedInstruction>& table) {
+    decoded.resize(table.size());
+    for (size_t addr = 0; addr < table.size(); ++addr) {
+        decoded[addr].insn = table[addr];
+        decoded[addr].handler = handler_for(table[addr]);
+    }
+}
+
+template <class Config>
+const Superblock& BasicFunctionalCore<Config>::superblock_at(unsigned start) {
+    Superblock& block = superblocks[start];
+    if (!block.translated) {
+        // Stop before the first instruction that can end execution, and at
+        // the last address so the PC wraps in step()
+        unsigned end = start;
+        while (end < Config::ADDR_MASK && !ends_superblock(decoded[end].insn)) {
+            ++end;
+            if (is_branch(decoded[end - 1].insn.opcode)) {
+                break;
+            }
+        }
+        block.length = end - start;
+        block.translated = true;
+        ++superblock_translations;
+    }
+    return block;
+}
+
+template <class Config>
+void BasicFunctionalCore<Config>::run_superblock(const Superblock& block) {
+    const BoundInstruction* op = &decoded[pc];
+    const BoundInstruction* end = op + block.length;
+    if (profiler) {
+        for (const BoundInstruction* i = op; i != end; ++i) {
+            profiler->count_instruction(i->insn);
+        }
+    }
+    // Set first, so a branch at the end of the block can override it
+    pc = (pc + block.length) & Config::ADDR_MASK;
+    for (; op != end; ++op) {
+        op->handler(*this, op->insn);
+    }
+    instructions_executed += block.length;
+}
+
+template <class Config>
+void BasicFunctionalCore<Config>::invalidate_superblocks(unsigned addr) {
+    // A block ending just before addr depends on it too, since addr decided
+    // where the block stops
+    for (unsigned start = 0; start <= addr; ++start) {
+        Superblock& block = superblocks[start];
+        if (block.translated && start + block.length >= addr) {
+            block = Superblock();
+        }
+    }
+}
+
+template <class Config>
+void BasicFunctionalCore<Config>::invalidate_superblocks() {
+    for (Superblock& block : superblocks) {
+        block = Superblock();
+    }
+}
+
+template <class Config>
+FunctionalCoreBase::StopReason BasicFunctionalCore<Config>::run(uint64_t max_instructions) {
+    StopReason reason = RUNNING;
+    uint64_t executed = 0;
+    while (executed < max_instructions && reason == RUNNING) {
+        if (use_superblocks) {
+            const Superblock& block = superblock_at(pc);
+            if (block.length > 0 && block.length <= max_instructions - executed) {
+                run_superblock(block);
+                executed += block.length;
+                continue;
+            }
+        }
+        reason = step();
+        ++executed;
+    }
+    return reason;
+}
+
+template <class Config>
+FunctionalCoreBase::StopReason BasicFunctionalCore<Config>::run_until(unsigned stop_pc, uint64_t max_instructions) {
+    StopReason reason = RUNNING;
+    uint64_t executed = 0;
+    while (executed < max_instructions && reason == RUNNING) {
+        if (use_superblocks) {
+            const Superblock& block = superblock_at(pc);
+            // Instructions until the PC next equals stop_pc, from 1 to 1 << Config::ADDR_SIZE
+            unsigned distance = ((stop_pc - pc - 1) & Config::ADDR_MASK) + 1;
+            if (block.length > 0 && block.length <= max_instructions - executed && block.length < distance) {
+                run_superblock(block);
+                executed += block.length;
+                if (pc == stop_pc) {
+                    break; // Reached through the branch that ended the block
+                }
+                continue;
+            }
+        }
+        reason = step();
+        ++executed;
+        if (pc == stop_pc) {
+            break;
+        }
+    }
+    return reason;
+}
+
+template class BasicFunctionalCore<Word8CpuConfig>;
+template class BasicFunctionalCore<DefaultCpuConfig>;
+template class BasicFunctionalCore<Word32CpuConfig>;
@@ -0,0 +1,176 @@
+#ifndef FUNCTIONAL_CORE_H
+#define FUNCTIONAL_CORE_H
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "common.h"
+#include "decoder.h"
+#include "profiler.h"
+#include "branch_predictor.h"
+
+// Data accesses that fall outside FunctionalCore's directly mapped window,
+// e.g. memory-mapped devices reached through TLM b_transport.
+class DataBus {
+public:
+    virtual ~DataBus() {}
+    virtual uint16_t read(unsigned addr) = 0;
+    virtual void write(unsigned addr, uint16_t value) = 0;
+};
+
+// The bus type of configurations that cannot have one. It is never
+// defined, so the only pointer to it is nullptr.
+class NoDataBus;
+
+// A straight-line run of the predecoded program starting at start: length
+// instructions whose handlers never stop execution, executed back to back
+// by calling their pre-bound handlers. A branch or jump is the last
+// instruction of its block and sets the PC for the next one. An instruction
+// that stops execution (a HALT, a WFI, an address past the program), a
+// LOAD or STORE that reaches the bus, or one at the last address, where the
+// PC wraps, is left to step().
+struct Superblock {
+    bool translated;
+    unsigned length;
+
+    Superblock() : translated(false), length(0) {}
+};
+
+// Shared by every configuration, so results of different ones compare
+class FunctionalCoreBase {
+public:
+    enum StopReason {
+        RUNNING,
+        HALTED,
+        PC_OUT_OF_BOUNDS,
+        WAITING_FOR_INTERRUPT // At a WFI; call complete_wait() once the interrupt is seen
+    };
+};
+
+// Plain C++ model of the ISA in common.h. It holds the whole architectural
+// state (registers, PC, instruction and data memory) and executes one
+// instruction per step() without touching the SystemC kernel.
+//
+// Widths and the register count come from Config, a CpuConfig. Registers
+// and data words are Config::native_word and wrap at WORD_SIZE bits;
+// instructions stay 16 bits in every configuration. FunctionalCore is the
+// default configuration, the one SimpleCPU runs; the 8, 16 and 32-bit
+// configurations in common.h are instantiated in functional_core.cpp.
+// Only configurations with the default WORD_SIZE have a bus, since
+// everything behind one (DataMemory, devices, TLM sockets) is 16 bits wide.
+// The others run standalone on their own data memory, and their bus is a
+// NoDataBus, so attaching a 16-bit bus to them does not compile.
+//
+// run() and run_until() execute whole superblocks where the instruction
+// budget allows, so dispatch, PC update and counting happen once per block
+// rather than once per instruction. Blocks are translated on first use,
+// cached by start PC and invalidated when instruction memory changes
+// through load_program() or write_program(), or when the data window
+// changes size.
+//
+// While a block runs, pc and instructions_executed still hold their values
+// from the start of the block. That is only safe because no instruction in
+// a block can call out of the core: LOAD and STORE addresses are immediates,
+// so the ones that fall outside the data window are known when the block is
+// translated, and they end it. Every bus access therefore happens in step(),
+// with the same pc and instructions_executed as when stepping.
+template <class Config>
+class BasicFunctionalCore : public FunctionalCoreBase {
+public:
+    typedef typename Config::native_word data_word;
+    typedef typename std::conditional<Config::WORD_SIZE == WORD_SIZE, DataBus, NoDataBus>::type Bus;
+    // Executes one predecoded instruction. Returns false when execution has
+    // to stop; the reason is left in stop_reason.
+    typedef bool (*Handler)(BasicFunctionalCore& core, const DecodedInstruction& insn);
+
+    // A predecoded instruction with the handler that executes it
+    struct BoundInstruction {
+        DecodedInstruction insn;
+        Handler handler;
+    };
+
+    std::vector<uint16_t> program;          // Instruction memory
+    std::vector<BoundInstruction> decoded;  // Predecoded program, see predecode_program
+    std::vector<data_word> memory;            // Data memory, 1 << ADDR_SIZE words
+    // Window of data memory accessed directly: memory itself by default, or a
+    // DMI region. Addresses past the window go to bus.
+    data_word* data;
+    unsigned data_words;
+    Bus* bus;
+    Profiler* profiler; // Optional; built for Config::ADDR_SIZE
+    // Optional. Every conditional branch is predicted and resolved as it
+    // executes; a misprediction adds branch_penalty to branch_stall_cycles,
+    // for the owner to turn into time.
+    BranchPredictor* predictor;
+    unsigned branch_penalty; // Default 2, as in the pipeline, which resolves branches in EX
+    uint64_t branch_stall_cycles;
+    data_word registers[Config::NUM_REGISTERS];
+    unsigned pc;
+    uint64_t instructions_executed;
+    uint64_t unknown_opcodes;     // Executed as no-ops
+    bool report_unknown_opcodes;  // SC_REPORT_WARNING for each; off when running outside the kernel thread
+    bool use_superblocks;         // False to run() one step() at a time
+    uint64_t superblock_translations;
+    StopReason stop_reason;
+
+    BasicFunctionalCore();
+    BasicFunctionalCore(const BasicFunctionalCore& other);
+    BasicFunctionalCore& operator=(const BasicFunctionalCore& other);
+
+    void reset();
+    void load_program(const std::vector<uint16_t>& program);
+    // Same, with the table already built by predecode_program for
+    // Config::ADDR_SIZE
+    void load_program(const std::vector<uint16_t>& program, const std::vector<DecodedInstruction>& decoded);
+    // Store into instruction memory. Returns false for addresses past the
+    // end of the loaded program.
+    bool write_program(unsigned addr, uint16_t value);
+    StopReason step();
+    // Retire the WFI the core stopped at and move past it
+    void complete_wait();
+    StopReason run(uint64_t max_instructions = UINT64_MAX);
+    // Like run, but also stop as soon as the PC reaches stop_pc, after at
+    // least one instruction. Returns RUNNING in both cases.
+    StopReason run_until(unsigned stop_pc, uint64_t max_instructions = UINT64_MAX);
+
+    void attach_data(data_word* base, unsigned words);
+    void use_own_memory();
+
+    data_word read_data(unsigned addr) {
+        return addr < data_words ? data[addr] : bus_read(addr);
+    }
+    void write_data(unsigned addr, data_word value) {
+        if (addr < data_words) {
+            data[addr] = value;
+        } else {
+            bus_write(addr, value);
+        }
+    }
+
+    data_word& reg(unsigned field) {
+        return registers[Config::register_index(field)];
+    }
+
+    static Handler handler_for(const DecodedInstruction& insn);
+
+private:
+    std::vector<Superblock> superblocks; // Indexed by start PC
+
+    bool ends_superblock(const DecodedInstruction& insn) const;
+    void bind(const std::vector<DecodedInstruction>& table);
+    const Superblock& superblock_at(unsigned start);
+    void run_superblock(const Superblock& block);
+    void invalidate_superblocks(unsigned addr);
+    void invalidate_superblocks();
+
+    data_word bus_read(unsigned addr);
+    void bus_write(unsigned addr, data_word value);
+};
+
+typedef BasicFunctionalCore<DefaultCpuConfig> FunctionalCore;
+
+extern template class BasicFunctionalCore<Word8CpuConfig>;
+extern template class BasicFunctionalCore<DefaultCpuConfig>;
+extern template class BasicFunctionalCore<Word32CpuConfig>;
+
+#endif // FUNCTIONAL_CORE_H
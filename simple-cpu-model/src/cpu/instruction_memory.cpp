@@ -1,17 +1,74 @@
 #include "instruction_memory.h"
+#include "functional_core.h"
+#include "memory_transport.h"
+#include "sim_stats.h"
+#include "trace_log.h"
 #include <systemc.h>
 #include <vector>
 
     void InstructionMemory::load_program(const std::vector<word>& program) {
-        memory = program;
+        memory.assign(program.begin(), program.end());
+        program_loaded();
+    }
+    void InstructionMemory::load_program(const uint16_t* words, size_t count) {
+        memory.assign(words, words + count);
+        program_loaded();
+    }
+    void InstructionMemory::program_loaded() {
+        if (memory.size() > (1u << ADDR_SIZE)) {
+            SC_REPORT_WARNING("InstructionMemory", "Program is larger than the address space; the excess is unreachable.");
+        }
+        predecode_program(memory, decoded);
+        // The vector may have moved, so drop any DMI pointers handed out
+        if (socket.size() > 0) {
+            socket->invalidate_direct_mem_ptr(0, ~sc_dt::uint64(0));
+        }
         SC_REPORT_INFO("InstructionMemory", "Program loaded.");
     }
     void InstructionMemory::read_instruction() {
-        if (addr_in.read() < memory.size()) {
-            instruction_out.write(memory[addr_in.read()]);
+        ++SimStats::process_activations;
+        // The decoded table spans the whole address space
+        const DecodedInstruction& insn = decoded[addr_in.read()];
+        if (insn.valid) {
+            TRACE_ACCESS(TRACE_FETCH, TRACE_ACCESSES, false, insn.addr, insn.raw);
+            instruction_out.write(insn.raw);
         } else {
             SC_REPORT_ERROR("InstructionMemory", "Address out of bounds!");
             instruction_out.write(0); // Or some default invalid instruction
         }
+        decoded_out.write(insn);
+    }
+
+    unsigned InstructionMemory::transport(tlm::tlm_generic_payload& trans) {
+        unsigned len = transport_words(memory, trans, true);
+        if (len > 0 && trans.get_command() == tlm::TLM_WRITE_COMMAND) {
+            // Re-decode only the words that were touched
+            unsigned first = trans.get_address() / sizeof(uint16_t);
+            unsigned last = (trans.get_address() + len - 1) / sizeof(uint16_t);
+            for (unsigned i = first; i <= last && i < decoded.size(); ++i) {
+                decoded[i] = decode_instruction(memory[i], i);
+                if (iss_core) {
+                    iss_core->write_program(i, memory[i]);
+                }
+            }
+        }
+        return len;
+    }
+
+    void InstructionMemory::b_transport(tlm::tlm_generic_payload& trans, sc_time& delay) {
+        transport(trans);
+        delay += latency;
+    }
+
+    unsigned InstructionMemory::transport_dbg(tlm::tlm_generic_payload& trans) {
+        return transport(trans);
+    }
+
+    bool InstructionMemory::get_direct_mem_ptr(tlm::tlm_generic_payload&, tlm::tlm_dmi& dmi) {
+        if (memory.empty()) {
+            return false;
+        }
+        describe_dmi_region(memory, dmi, false, latency);
+        return true;
     }
-    
\ No newline at end of file
+    
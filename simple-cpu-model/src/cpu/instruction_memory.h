@@ -2,23 +2,58 @@
 #define INSTRUCTION_MEMORY_H
 
 #include "systemc.h"
+#include <tlm.h>
+#include <tlm_utils/simple_target_socket.h>
+#include <cstdint>
 #include <vector>
 #include "common.h"
+#include "decoder.h"
+#include "functional_core.h"
 
 SC_MODULE(InstructionMemory) {
+    // Pin-level interface, used by the signal-level datapath
     sc_in<address> addr_in;
     sc_out<word> instruction_out;
+    sc_out<DecodedInstruction> decoded_out;
 
-    std::vector<word> memory;
+    // Transaction-level interface. Addresses are in bytes, two per word.
+    // Binding it is optional. DMI is read-only so the decoded table below
+    // can never go stale behind our back.
+    tlm_utils::simple_target_socket_optional<InstructionMemory> socket;
+
+    std::vector<uint16_t> memory;
+    // Side table built by load_program; it is only rebuilt when a new
+    // program is loaded, so memory must not be modified directly.
+    std::vector<DecodedInstruction> decoded;
+    sc_time latency; // Added to b_transport delays and reported for DMI
+    // Optional. Its copy of the program gets every TLM write, so stores into
+    // instruction memory invalidate its superblocks while an ISS mode runs.
+    FunctionalCore* iss_core;
 
     void load_program(const std::vector<word>& program) ;
+    // Bulk load from plain words, e.g. a mapped ProgramImage segment
+    void load_program(const uint16_t* words, size_t count);
     void read_instruction();
+
+    void b_transport(tlm::tlm_generic_payload& trans, sc_time& delay);
+    unsigned transport_dbg(tlm::tlm_generic_payload& trans);
+    bool get_direct_mem_ptr(tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi);
     // Constructor
-    SC_CTOR(InstructionMemory) {
+    SC_CTOR(InstructionMemory) : socket("socket"), latency(SC_ZERO_TIME), iss_core(nullptr) {
+        predecode_program(memory, decoded);
+
         SC_METHOD(read_instruction);
         sensitive << addr_in;
         dont_initialize();
+
+        socket.register_b_transport(this, &InstructionMemory::b_transport);
+        socket.register_transport_dbg(this, &InstructionMemory::transport_dbg);
+        socket.register_get_direct_mem_ptr(this, &InstructionMemory::get_direct_mem_ptr);
     }
+
+private:
+    void program_loaded();
+    unsigned transport(tlm::tlm_generic_payload& trans);
 };
 
-#endif // INSTRUCTION_MEMORY_H
\ No newline at end of file
+#endif // INSTRUCTION_MEMORY_H
@@ -0,0 +1,204 @@
+#include "lane_core.h"
+#include <algorithm>
+
+template <unsigned LANES>
+LaneCore<LANES>::LaneCore() : memory(static_cast<size_t>(DATA_WORDS) * LANES, 0) {
+    predecode_program(std::vector<uint16_t>(), decoded);
+    reset();
+}
+
+template <unsigned LANES>
+void LaneCore<LANES>::reset() {
+    for (int r = 0; r < NUM_REGISTERS; ++r) {
+        std::fill(registers[r], registers[r] + LANES, 0);
+    }
+    std::fill(active, active + LANES, 0xFFFF);
+    pc = 0;
+    instructions_executed = 0;
+    unknown_opcodes = 0;
+    stop_reason = FunctionalCore::RUNNING;
+    diverged = false;
+}
+
+template <unsigned LANES>
+void LaneCore<LANES>::load_program(const std::vector<uint16_t>& program) {
+    predecode_program(program, decoded);
+}
+
+template <unsigned LANES>
+bool LaneCore<LANES>::load_data(unsigned lane, const std::vector<uint16_t>& data) {
+    size_t words = std::min(data.size(), static_cast<size_t>(DATA_WORDS));
+    for (size_t addr = 0; addr < DATA_WORDS; ++addr) {
+        memory[addr * LANES + lane] = addr < words ? data[addr] : 0;
+    }
+    return words == data.size();
+}
+
+template <unsigned LANES>
+void LaneCore<LANES>::set_active_lanes(unsigned count) {
+    for (unsigned l = 0; l < LANES; ++l) {
+        active[l] = l < count ? 0xFFFF : 0;
+    }
+}
+
+template <unsigned LANES>
+void LaneCore<LANES>::deactivate(unsigned lane) {
+    active[lane] = 0;
+}
+
+template <unsigned LANES>
+FunctionalCore::StopReason LaneCore<LANES>::step() {
+    // Same semantics as the FunctionalCore handlers, one lane per element
+    const DecodedInstruction& insn = decoded[pc];
+    if (!insn.valid) {
+        stop_reason = FunctionalCore::PC_OUT_OF_BOUNDS;
+        return stop_reason;
+    }
+
+    alignas(64) uint16_t result[LANES];
+    switch (insn.opcode) {
+        case LOAD:
+            blend(registers[insn.rd], word_at(insn.immediate));
+            break;
+        case STORE:
+            blend(word_at(insn.immediate), registers[insn.rs1]);
+            break;
+        case ADD:
+            for (unsigned l = 0; l < LANES; ++l) {
+                result[l] = static_cast<uint16_t>(registers[insn.rs1][l] + registers[insn.rs2][l]);
+            }
+            blend(registers[insn.rd], result);
+            break;
+        case SUB:
+            for (unsigned l = 0; l < LANES; ++l) {
+                result[l] = static_cast<uint16_t>(registers[insn.rs1][l] - registers[insn.rs2][l]);
+            }
+            blend(registers[insn.rd], result);
+            break;
+        case HALT:
+            ++instructions_executed;
+            std::fill(active, active + LANES, 0);
+            stop_reason = FunctionalCore::HALTED;
+            return stop_reason;
+        case WFI:
+            // No interrupts in a batch; stop at the WFI like FunctionalCore
+            stop_reason = FunctionalCore::WAITING_FOR_INTERRUPT;
+            return stop_reason;
+        case BEQZ:
+        case BNEZ: {
+            unsigned lanes = 0, taken = 0;
+            for (unsigned l = 0; l < LANES; ++l) {
+                if (active[l]) {
+                    ++lanes;
+                    taken += (registers[insn.rs1][l] == 0) == (insn.opcode == BEQZ);
+                }
+            }
+            if (taken != 0 && taken != lanes) {
+                diverged = true;
+                return FunctionalCore::RUNNING;
+            }
+            if (taken > 0) {
+                pc = insn.target;
+                ++instructions_executed;
+                return FunctionalCore::RUNNING;
+            }
+            break;
+        }
+        case JMP:
+            pc = insn.target;
+            ++instructions_executed;
+            return FunctionalCore::RUNNING;
+        default:
+            ++unknown_opcodes;
+            break;
+    }
+
+    pc = (pc + 1) & ADDR_MASK;
+    ++instructions_executed;
+    return FunctionalCore::RUNNING;
+}
+
+template <unsigned LANES>
+FunctionalCore::StopReason LaneCore<LANES>::run(uint64_t max_instructions) {
+    FunctionalCore::StopReason reason = FunctionalCore::RUNNING;
+    for (uint64_t i = 0; i < max_instructions && reason == FunctionalCore::RUNNING && !diverged; ++i) {
+        reason = step();
+    }
+    return reason;
+}
+
+// Continue one lane of a diverged LaneCore from where it stopped, on a copy
+// of scalar, which has the program loaded
+template <unsigned LANES>
+static void finish_lane(const LaneCore<LANES>& lanes, unsigned lane, const FunctionalCore& scalar,
+                        uint64_t max_instructions, BatchResult& result) {
+    FunctionalCore core = scalar;
+    for (unsigned addr = 0; addr < LaneCore<LANES>::DATA_WORDS; ++addr) {
+        core.memory[addr] = lanes.read_data(lane, addr);
+    }
+    for (int r = 0; r < NUM_REGISTERS; ++r) {
+        core.registers[r] = lanes.registers[r][lane];
+    }
+    core.pc = lanes.pc;
+    core.instructions_executed = lanes.instructions_executed;
+    core.unknown_opcodes = lanes.unknown_opcodes;
+
+    result.stop_reason = core.run(max_instructions - lanes.instructions_executed);
+    result.instructions = core.instructions_executed;
+    result.unknown_opcodes = core.unknown_opcodes;
+    result.pc = core.pc;
+    std::copy(core.registers, core.registers + NUM_REGISTERS, result.registers);
+    result.memory.swap(core.memory);
+}
+
+template <unsigned LANES>
+std::vector<BatchResult> run_test_vectors(const std::vector<uint16_t>& program,
+                                          const std::vector<std::vector<uint16_t>>& data_sets,
+                                          uint64_t max_instructions) {
+    std::vector<BatchResult> results(data_sets.size());
+    LaneCore<LANES> core;
+    core.load_program(program);
+    FunctionalCore scalar; // For lanes that diverge
+    scalar.report_unknown_opcodes = false;
+    scalar.load_program(program);
+    for (size_t first = 0; first < data_sets.size(); first += LANES) {
+        unsigned lanes = static_cast<unsigned>(std::min<size_t>(LANES, data_sets.size() - first));
+        core.reset();
+        core.set_active_lanes(lanes);
+        for (unsigned l = 0; l < LANES; ++l) {
+            bool complete = core.load_data(l, l < lanes ? data_sets[first + l] : std::vector<uint16_t>());
+            if (l < lanes) {
+                results[first + l].data_truncated = !complete;
+            }
+        }
+
+        FunctionalCore::StopReason reason = core.run(max_instructions);
+        for (unsigned l = 0; l < lanes; ++l) {
+            BatchResult& result = results[first + l];
+            if (core.diverged) {
+                finish_lane(core, l, scalar, max_instructions, result);
+                continue;
+            }
+            result.stop_reason = reason;
+            result.instructions = core.instructions_executed;
+            result.unknown_opcodes = core.unknown_opcodes;
+            result.pc = core.pc;
+            for (int r = 0; r < NUM_REGISTERS; ++r) {
+                result.registers[r] = core.registers[r][l];
+            }
+            result.memory.resize(LaneCore<LANES>::DATA_WORDS);
+            for (unsigned addr = 0; addr < LaneCore<LANES>::DATA_WORDS; ++addr) {
+                result.memory[addr] = core.read_data(l, addr);
+            }
+        }
+    }
+    return results;
+}
+
+template class LaneCore<8>;
+template class LaneCore<16>;
+template class LaneCore<32>;
+
+template std::vector<BatchResult> run_test_vectors<8>(const std::vector<uint16_t>&, const std::vector<std::vector<uint16_t>>&, uint64_t);
+template std::vector<BatchResult> run_test_vectors<16>(const std::vector<uint16_t>&, const std::vector<std::vector<uint16_t>>&, uint64_t);
+template std::vector<BatchResult> run_test_vectors<32>(const std::vector<uint16_t>&, const std::vector<std::vector<uint16_t>>&, uint64_t);
@@ -0,0 +1,86 @@
+#ifndef LANE_CORE_H
+#define LANE_CORE_H
+
+#include <cstdint>
+#include <vector>
+#include "common.h"
+#include "decoder.h"
+#include "functional_core.h"
+#include "batch_runner.h"
+
+// FunctionalCore for LANES contexts at once: one program, LANES independent
+// register files and data memories, for evaluating the same program over
+// many test vectors. State is kept as structure of arrays, with each
+// register and each data word holding LANES consecutive uint16_t, so every
+// instruction is one loop over the lanes that the compiler turns into 16-bit
+// vector operations (LANES = 8, 16, 32 fill a 128, 256, 512-bit register).
+//
+// Lanes run in lockstep, since they share the PC. A lane only stops
+// changing when it is masked out: lanes past set_active_lanes() in a partly
+// filled batch, or lanes stopped with deactivate(). Masked lanes are
+// blended out rather than skipped, so the loops stay branch-free.
+//
+// A conditional branch the active lanes disagree on cannot be followed in
+// lockstep: run() stops on it with diverged set, and run_test_vectors
+// finishes each lane of the group on its own FunctionalCore.
+template <unsigned LANES>
+class LaneCore {
+public:
+    static_assert(LANES == 8 || LANES == 16 || LANES == 32, "LaneCore supports 8, 16 or 32 lanes");
+    static const unsigned DATA_WORDS = 1u << ADDR_SIZE; // Per lane, as in FunctionalCore
+
+    alignas(64) uint16_t registers[NUM_REGISTERS][LANES];
+    alignas(64) uint16_t active[LANES]; // 0xFFFF for lanes that execute, 0 for masked ones
+    std::vector<uint16_t> memory;       // DATA_WORDS * LANES, word address major
+    std::vector<DecodedInstruction> decoded;
+    unsigned pc;
+    uint64_t instructions_executed;
+    uint64_t unknown_opcodes;
+    FunctionalCore::StopReason stop_reason;
+    bool diverged; // Stopped at a branch that goes both ways; the PC is on it
+
+    LaneCore();
+
+    // Zero registers and PC and activate every lane. Data memory is kept.
+    void reset();
+    void load_program(const std::vector<uint16_t>& program);
+    // Data memory of lane, from address 0. Returns false if it was truncated.
+    bool load_data(unsigned lane, const std::vector<uint16_t>& data);
+
+    void set_active_lanes(unsigned count); // Lanes [0, count) execute
+    void deactivate(unsigned lane);
+
+    uint16_t read_data(unsigned lane, unsigned addr) const {
+        return memory[static_cast<size_t>(addr) * LANES + lane];
+    }
+
+    FunctionalCore::StopReason step();
+    FunctionalCore::StopReason run(uint64_t max_instructions = UINT64_MAX);
+
+private:
+    uint16_t* word_at(unsigned addr) { return &memory[static_cast<size_t>(addr) * LANES]; }
+
+    // dst = active ? src : dst, lane by lane
+    void blend(uint16_t* dst, const uint16_t* src) {
+        for (unsigned l = 0; l < LANES; ++l) {
+            dst[l] = static_cast<uint16_t>((src[l] & active[l]) | (dst[l] & ~active[l]));
+        }
+    }
+};
+
+extern template class LaneCore<8>;
+extern template class LaneCore<16>;
+extern template class LaneCore<32>;
+
+// Run program once per entry of data_sets, LANES contexts at a time, and
+// return the same results BatchRunner::run would for the equivalent jobs.
+template <unsigned LANES>
+std::vector<BatchResult> run_test_vectors(const std::vector<uint16_t>& program,
+                                          const std::vector<std::vector<uint16_t>>& data_sets,
+                                          uint64_t max_instructions = UINT64_MAX);
+
+extern template std::vector<BatchResult> run_test_vectors<8>(const std::vector<uint16_t>&, const std::vector<std::vector<uint16_t>>&, uint64_t);
+extern template std::vector<BatchResult> run_test_vectors<16>(const std::vector<uint16_t>&, const std::vector<std::vector<uint16_t>>&, uint64_t);
+extern template std::vector<BatchResult> run_test_vectors<32>(const std::vector<uint16_t>&, const std::vector<std::vector<uint16_t>>&, uint64_t);
+
+#endif // LANE_CORE_H
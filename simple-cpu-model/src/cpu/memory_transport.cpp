@@ -0,0 +1,115 @@
+#include "memory_transport.h"
+#include <algorithm>
+#include <cstring>
+
+// Checks common to both stores. Sets the error response and returns false
+// if trans cannot be performed on size bytes.
+static bool check_transaction(tlm::tlm_generic_payload& trans, sc_dt::uint64 size, bool writable) {
+    sc_dt::uint64 addr = trans.get_address();
+    unsigned len = trans.get_data_length();
+
+    if (addr >= size || len > size - addr) {
+        trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+        return false;
+    }
+    if (trans.get_byte_enable_ptr() != nullptr) {
+        trans.set_response_status(tlm::TLM_BYTE_ENABLE_ERROR_RESPONSE);
+        return false;
+    }
+    if (trans.get_streaming_width() < len) {
+        trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
+        return false;
+    }
+    if (trans.get_command() == tlm::TLM_WRITE_COMMAND && !writable) {
+        trans.set_response_status(tlm::TLM_COMMAND_ERROR_RESPONSE);
+        return false;
+    }
+    return true;
+}
+
+unsigned transport_words(std::vector<uint16_t>& memory, tlm::tlm_generic_payload& trans, bool writable) {
+    tlm::tlm_command cmd = trans.get_command();
+    sc_dt::uint64 addr = trans.get_address();
+    unsigned char* ptr = trans.get_data_ptr();
+    unsigned len = trans.get_data_length();
+
+    if (!check_transaction(trans, memory.size() * sizeof(uint16_t), writable)) {
+        return 0;
+    }
+
+    unsigned char* base = reinterpret_cast<unsigned char*>(memory.data()) + addr;
+    if (cmd == tlm::TLM_READ_COMMAND) {
+        std::memcpy(ptr, base, len);
+    } else if (cmd == tlm::TLM_WRITE_COMMAND) {
+        std::memcpy(base, ptr, len);
+    } else {
+        len = 0; // TLM_IGNORE_COMMAND
+    }
+
+    trans.set_dmi_allowed(true);
+    trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    return len;
+}
+
+void describe_dmi_region(std::vector<uint16_t>& memory, tlm::tlm_dmi& dmi, bool writable, const sc_time& latency) {
+    dmi.set_dmi_ptr(reinterpret_cast<unsigned char*>(memory.data()));
+    dmi.set_start_address(0);
+    dmi.set_end_address(memory.size() * sizeof(uint16_t) - 1);
+    dmi.set_read_latency(latency);
+    dmi.set_write_latency(latency);
+    if (writable) {
+        dmi.allow_read_write();
+    } else {
+        dmi.allow_read();
+    }
+}
+
+unsigned transport_words(PagedMemory& memory, tlm::tlm_generic_payload& trans, bool writable) {
+    const sc_dt::uint64 page_bytes = PagedMemory::PAGE_WORDS * sizeof(uint16_t);
+    tlm::tlm_command cmd = trans.get_command();
+    sc_dt::uint64 addr = trans.get_address();
+    unsigned char* ptr = trans.get_data_ptr();
+    unsigned len = trans.get_data_length();
+
+    if (!check_transaction(trans, memory.size() * sizeof(uint16_t), writable)) {
+        return 0;
+    }
+    if (cmd != tlm::TLM_READ_COMMAND && cmd != tlm::TLM_WRITE_COMMAND) {
+        len = 0; // TLM_IGNORE_COMMAND
+    }
+
+    for (unsigned done = 0; done < len;) {
+        sc_dt::uint64 page = (addr + done) / page_bytes;
+        unsigned offset = static_cast<unsigned>((addr + done) % page_bytes);
+        unsigned n = static_cast<unsigned>(std::min<sc_dt::uint64>(len - done, page_bytes - offset));
+        if (cmd == tlm::TLM_READ_COMMAND) {
+            std::memcpy(ptr + done, reinterpret_cast<const unsigned char*>(memory.page_for_read(page)) + offset, n);
+        } else {
+            std::memcpy(reinterpret_cast<unsigned char*>(memory.page_for_write(page)) + offset, ptr + done, n);
+        }
+        done += n;
+    }
+
+    trans.set_dmi_allowed(true);
+    trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    return len;
+}
+
+bool describe_dmi_region(PagedMemory& memory, sc_dt::uint64 addr, tlm::tlm_dmi& dmi, bool writable, const sc_time& latency) {
+    const sc_dt::uint64 page_bytes = PagedMemory::PAGE_WORDS * sizeof(uint16_t);
+    if (addr >= memory.size() * sizeof(uint16_t)) {
+        return false;
+    }
+    sc_dt::uint64 page = addr / page_bytes;
+    dmi.set_dmi_ptr(reinterpret_cast<unsigned char*>(memory.page_for_write(page)));
+    dmi.set_start_address(page * page_bytes);
+    dmi.set_end_address(std::min<sc_dt::uint64>((page + 1) * page_bytes, memory.size() * sizeof(uint16_t)) - 1);
+    dmi.set_read_latency(latency);
+    dmi.set_write_latency(latency);
+    if (writable) {
+        dmi.allow_read_write();
+    } else {
+        dmi.allow_read();
+    }
+    return true;
+}
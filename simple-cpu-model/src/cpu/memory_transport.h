@@ -0,0 +1,31 @@
+#ifndef MEMORY_TRANSPORT_H
+#define MEMORY_TRANSPORT_H
+
+#include <systemc.h>
+#include <tlm.h>
+#include <cstdint>
+#include <vector>
+#include "paged_memory.h"
+
+// Helpers shared by the TLM target sockets of DataMemory and
+// InstructionMemory. Both expose their backing store as a byte-addressed
+// region: word i lives at bytes [2*i, 2*i+1] in host byte order, which is
+// also what a DMI pointer into the store sees.
+
+// Perform a read or write on memory. Returns the number of bytes
+// transferred and sets the response status; writes are rejected with
+// TLM_COMMAND_ERROR_RESPONSE unless writable is set.
+unsigned transport_words(std::vector<uint16_t>& memory, tlm::tlm_generic_payload& trans, bool writable);
+
+// Describe the whole of memory as a DMI region.
+void describe_dmi_region(std::vector<uint16_t>& memory, tlm::tlm_dmi& dmi, bool writable, const sc_time& latency);
+
+// The same for paged memory. Transactions may cross page boundaries; writes
+// allocate the pages they touch.
+unsigned transport_words(PagedMemory& memory, tlm::tlm_generic_payload& trans, bool writable);
+
+// Describe the page holding byte address addr as a DMI region, giving it
+// its own storage first. Returns false if addr is out of range.
+bool describe_dmi_region(PagedMemory& memory, sc_dt::uint64 addr, tlm::tlm_dmi& dmi, bool writable, const sc_time& latency);
+
+#endif // MEMORY_TRANSPORT_H
@@ -0,0 +1,94 @@
+#include "mmio.h"
+#include "sim_stats.h"
+#include <cmath>
+
+Timer::Timer(sc_module_name name, const sc_time& period) :
+    sc_module(name),
+    period(period),
+    expirations(0),
+    reload(0),
+    control(0),
+    expired(false),
+    running(false)
+{
+    SC_METHOD(expire);
+    sensitive << expire_event;
+    dont_initialize();
+
+    SC_METHOD(drive_irq);
+    sensitive << irq_event;
+    dont_initialize();
+}
+
+uint16_t Timer::read(unsigned offset) {
+    switch (offset) {
+        case COUNT:
+            if (!running) {
+                return 0;
+            }
+            return static_cast<uint16_t>(std::ceil((deadline - sc_time_stamp()) / period));
+        case CONTROL:
+            return control;
+        case STATUS:
+            return expired ? 1 : 0;
+        default:
+            return 0;
+    }
+}
+
+void Timer::write(unsigned offset, uint16_t value) {
+    switch (offset) {
+        case COUNT:
+            reload = value;
+            expire_event.cancel();
+            running = value > 0;
+            if (running) {
+                deadline = sc_time_stamp() + period * static_cast<double>(value);
+                expire_event.notify(deadline - sc_time_stamp());
+            }
+            break;
+        case CONTROL:
+            control = value;
+            break;
+        case STATUS:
+            if (value & 1) {
+                expired = false;
+                irq_event.notify(SC_ZERO_TIME);
+            }
+            break;
+    }
+}
+
+void Timer::expire() {
+    ++SimStats::process_activations;
+    ++expirations;
+    expired = true;
+    irq_event.notify(SC_ZERO_TIME);
+    if ((control & CONTROL_PERIODIC) && reload > 0) {
+        deadline += period * static_cast<double>(reload);
+        expire_event.notify(deadline - sc_time_stamp());
+    } else {
+        running = false;
+    }
+}
+
+void Timer::drive_irq() {
+    ++SimStats::process_activations;
+    irq.write(expired);
+}
+
+uint16_t Console::read(unsigned offset) {
+    return offset == STATUS ? 1 : 0;
+}
+
+void Console::write(unsigned offset, uint16_t value) {
+    if (offset != DATA) {
+        return;
+    }
+    char c = static_cast<char>(value & 0xFF);
+    output += c;
+    if (echo) {
+        echo->put(c);
+        echo->flush();
+    }
+}
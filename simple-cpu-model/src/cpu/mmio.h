@@ -0,0 +1,77 @@
+#ifndef MMIO_H
+#define MMIO_H
+
+#include <systemc.h>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// A device mapped into DataMemory's address space (see
+// DataMemory::map_device). Offsets are in words from the device's base.
+// Reads must not have side effects: the signal-level datapath reads
+// whatever address is on its pins, whether or not a LOAD executes.
+class MmioDevice {
+public:
+    virtual ~MmioDevice() {}
+    virtual unsigned words() const = 0;
+    virtual uint16_t read(unsigned offset) = 0;
+    virtual void write(unsigned offset, uint16_t value) = 0;
+};
+
+// Countdown timer that raises irq when it expires. Nothing happens per
+// clock cycle: the count is derived from the time of the access and expiry
+// is a single timed event, so the simulation can skip straight to it.
+//
+// COUNT    write n to expire n periods from now (0 stops the timer); reads
+//          the periods left
+// CONTROL  CONTROL_PERIODIC: reload COUNT on expiry instead of stopping
+// STATUS   bit 0 is set on expiry and drives irq; write 1 to clear it
+SC_MODULE(Timer), public MmioDevice {
+    enum Register { COUNT, CONTROL, STATUS, REGISTERS };
+    static const uint16_t CONTROL_PERIODIC = 1;
+
+    sc_out<bool> irq;
+
+    const sc_time period;
+    uint64_t expirations;
+
+    SC_HAS_PROCESS(Timer);
+    Timer(sc_module_name name, const sc_time& period = sc_time(10, SC_NS));
+
+    unsigned words() const override { return REGISTERS; }
+    uint16_t read(unsigned offset) override;
+    void write(unsigned offset, uint16_t value) override;
+
+private:
+    uint16_t reload;
+    uint16_t control;
+    bool expired;
+    bool running;
+    sc_time deadline;
+    sc_event expire_event;
+    sc_event irq_event; // irq is only written by drive_irq, whoever changes expired
+
+    void expire();
+    void drive_irq();
+};
+
+// Output-only console, like the transmit side of a UART. Every word written
+// to DATA appends its low byte to output and, if set, to echo.
+//
+// DATA    write a character
+// STATUS  reads 1: always ready to accept a character
+class Console : public MmioDevice {
+public:
+    enum Register { DATA, STATUS, REGISTERS };
+
+    std::string output;
+    std::ostream* echo; // Optional
+
+    explicit Console(std::ostream* echo = nullptr) : echo(echo) {}
+
+    unsigned words() const override { return REGISTERS; }
+    uint16_t read(unsigned offset) override;
+    void write(unsigned offset, uint16_t value) override;
+};
+
+#endif // MMIO_H
@@ -0,0 +1,44 @@
+#include "multi_core.h"
+#include <string>
+
+MultiCoreSystem::MultiCoreSystem(sc_module_name name, unsigned core_count,
+                                 ArbitrationPolicy policy, unsigned transfer_cycles) :
+    sc_module(name),
+    memory("memory"),
+    bus("bus", core_count, policy, transfer_cycles)
+{
+    memory.addr_in(idle_addr);
+    memory.data_in(idle_data_in);
+    memory.write_enable(idle_write_enable);
+    memory.data_out(idle_data_out);
+
+    for (unsigned i = 0; i < bus.ports; ++i) {
+        std::string core_name = "core" + std::to_string(i);
+        cores.emplace_back(new SimpleCPU(core_name.c_str(), PIPELINED));
+        cores.back()->use_shared_memory(memory, bus, i);
+    }
+    // The cores' clocks all start together, so any of them will do
+    bus.clk(*cores.front()->clk);
+}
+
+void MultiCoreSystem::set_instruction_limit(uint64_t instructions) {
+    for (const std::unique_ptr<SimpleCPU>& core : cores) {
+        core->set_instruction_limit(instructions);
+    }
+}
+
+uint64_t MultiCoreSystem::instructions_retired() const {
+    uint64_t total = 0;
+    for (const std::unique_ptr<SimpleCPU>& core : cores) {
+        total += core->instructions_retired();
+    }
+    return total;
+}
+
+void MultiCoreSystem::dump(std::ostream& os) const {
+    for (size_t i = 0; i < cores.size(); ++i) {
+        os << "Core " << i << ": ";
+        cores[i]->pipeline.dump(os);
+    }
+    bus.dump(os);
+}
@@ -0,0 +1,39 @@
+#ifndef MULTI_CORE_H
+#define MULTI_CORE_H
+
+#include <systemc.h>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "simple_cpu.h"
+#include "data_memory.h"
+#include "shared_bus.h"
+#include "common.h"
+
+// N PIPELINED SimpleCPUs sharing one DataMemory through a SharedBus. Each
+// core has its own program, registers and clock-driven pipeline; every LOAD
+// and STORE is arbitrated on the bus, so cores that access memory at the
+// same time stall each other. The simulation stops once every core has
+// drained (HALT or instruction limit).
+SC_MODULE(MultiCoreSystem) {
+    DataMemory memory; // Shared by all cores
+    SharedBus bus;
+    std::vector<std::unique_ptr<SimpleCPU>> cores;
+
+    // memory's pin-level ports are not used, but have to be bound
+    sc_signal<address> idle_addr;
+    sc_signal<word> idle_data_in, idle_data_out;
+    sc_signal<bool> idle_write_enable;
+
+    MultiCoreSystem(sc_module_name name, unsigned core_count,
+                    ArbitrationPolicy policy = ARBITRATE_ROUND_ROBIN, unsigned transfer_cycles = 1);
+
+    // Per-core stop after this many instructions, as SimpleCPU's
+    void set_instruction_limit(uint64_t instructions);
+    uint64_t instructions_retired() const; // All cores
+
+    // Per core CPI and stalls, then the bus
+    void dump(std::ostream& os) const;
+};
+
+#endif // MULTI_CORE_H
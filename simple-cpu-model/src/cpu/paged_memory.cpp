@@ -0,0 +1,142 @@
+#include "paged_memory.h"
+#include <systemc.h>
+#include <algorithm>
+#include <cstring>
+
+PagedMemory::PagedMemory(unsigned addr_bits) : allocated(0), mapped(0) {
+    if (addr_bits > 32) {
+        SC_REPORT_ERROR("PagedMemory", "Address spaces wider than 32 bits are not supported.");
+        addr_bits = 32;
+    }
+    words = uint64_t(1) << addr_bits;
+    zero_page.reset(new uint16_t[PAGE_WORDS]());
+    zero_table.reset(new uint16_t*[TABLE_SIZE]);
+    std::fill(zero_table.get(), zero_table.get() + TABLE_SIZE, zero_page.get());
+    dir.assign((pages() + TABLE_MASK) >> TABLE_BITS, zero_table.get());
+}
+
+uint16_t** PagedMemory::table_for_write(uint64_t page) {
+    uint16_t**& table = dir[page >> TABLE_BITS];
+    if (table == zero_table.get()) {
+        tables.emplace_back(new uint16_t*[TABLE_SIZE]);
+        table = tables.back().get();
+        std::copy(zero_table.get(), zero_table.get() + TABLE_SIZE, table);
+    }
+    return table;
+}
+
+uint16_t* PagedMemory::take_pool_page() {
+    if (free_pages.empty()) {
+        chunks.emplace_back(new uint16_t[POOL_CHUNK_PAGES * PAGE_WORDS]());
+        uint16_t* chunk = chunks.back().get();
+        for (unsigned i = POOL_CHUNK_PAGES; i-- > 0;) {
+            free_pages.push_back(chunk + i * PAGE_WORDS);
+        }
+    }
+    uint16_t* p = free_pages.back();
+    free_pages.pop_back();
+    return p;
+}
+
+uint16_t* PagedMemory::allocate_page(uint64_t page) {
+    // Pool pages are zero: new chunks are value-initialized and clear()
+    // zeroes pages before they go back
+    uint16_t* p = take_pool_page();
+    table_for_write(page)[page & TABLE_MASK] = p;
+    ++allocated;
+    return p;
+}
+
+bool PagedMemory::owns(const uint16_t* page) const {
+    for (const std::unique_ptr<uint16_t[]>& chunk : chunks) {
+        if (page >= chunk.get() && page < chunk.get() + POOL_CHUNK_PAGES * PAGE_WORDS) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t PagedMemory::copy_in(const uint16_t* src, size_t count, uint64_t base) {
+    if (base >= words) {
+        return 0;
+    }
+    count = static_cast<size_t>(std::min<uint64_t>(count, words - base));
+    size_t done = 0;
+    while (done < count) {
+        uint64_t addr = base + done;
+        size_t offset = addr & PAGE_MASK;
+        size_t n = std::min<size_t>(count - done, PAGE_WORDS - offset);
+        const uint16_t* from = src + done;
+        bool keep_zero = page_for_read(addr >> PAGE_BITS) == zero_page.get() &&
+                         std::all_of(from, from + n, [](uint16_t w) { return w == 0; });
+        if (!keep_zero) {
+            std::memcpy(page_for_write(addr >> PAGE_BITS) + offset, from, n * sizeof(uint16_t));
+        }
+        done += n;
+    }
+    return count;
+}
+
+size_t PagedMemory::map(uint16_t* src, size_t count, uint64_t base) {
+    if (base >= words) {
+        return 0;
+    }
+    count = static_cast<size_t>(std::min<uint64_t>(count, words - base));
+
+    // Partial first page
+    size_t head = std::min<size_t>(count, (PAGE_WORDS - (base & PAGE_MASK)) & PAGE_MASK);
+    size_t done = copy_in(src, head, base);
+
+    for (; count - done >= PAGE_WORDS; done += PAGE_WORDS) {
+        uint64_t page = (base + done) >> PAGE_BITS;
+        uint16_t*& entry = table_for_write(page)[page & TABLE_MASK];
+        if (owns(entry)) {
+            std::fill(entry, entry + PAGE_WORDS, 0);
+            free_pages.push_back(entry);
+            --allocated;
+        } else if (entry != zero_page.get()) {
+            --mapped;
+        }
+        entry = src + done;
+        ++mapped;
+    }
+
+    // Partial last page
+    return done + copy_in(src + done, count - done, base + done);
+}
+
+void PagedMemory::clear() {
+    std::fill(dir.begin(), dir.end(), zero_table.get());
+    tables.clear();
+    free_pages.clear();
+    for (std::unique_ptr<uint16_t[]>& chunk : chunks) {
+        std::fill(chunk.get(), chunk.get() + POOL_CHUNK_PAGES * PAGE_WORDS, 0);
+        for (unsigned i = POOL_CHUNK_PAGES; i-- > 0;) {
+            free_pages.push_back(chunk.get() + i * PAGE_WORDS);
+        }
+    }
+    allocated = 0;
+    mapped = 0;
+}
+
+std::vector<uint64_t> PagedMemory::resident_pages() const {
+    std::vector<uint64_t> result;
+    for (uint64_t d = 0; d < dir.size(); ++d) {
+        if (dir[d] == zero_table.get()) {
+            continue;
+        }
+        for (uint64_t t = 0; t < TABLE_SIZE; ++t) {
+            if (dir[d][t] != zero_page.get()) {
+                result.push_back((d << TABLE_BITS) | t);
+            }
+        }
+    }
+    return result;
+}
+
+size_t PagedMemory::resident_bytes() const {
+    return chunks.size() * POOL_CHUNK_PAGES * PAGE_WORDS * sizeof(uint16_t) +
+           (tables.size() + 1) * TABLE_SIZE * sizeof(uint16_t*) +
+           dir.size() * sizeof(uint16_t**) +
+           PAGE_WORDS * sizeof(uint16_t);
+}
@@ -0,0 +1,96 @@
+#ifndef PAGED_MEMORY_H
+#define PAGED_MEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Sparse memory of 16-bit words, for address spaces too large to allocate
+// densely. The space is split into pages of PAGE_WORDS words found through a
+// two-level table, so every access is two indexed loads and no search.
+// Pages that were never written all share one zero page; a page gets its own
+// storage on the first write, taken from a pool that allocates whole chunks
+// of pages at a time.
+//
+// A page is contiguous, so it can be handed out as a DMI region, or point
+// straight into caller-owned words such as a mapped ProgramImage (see map).
+class PagedMemory {
+public:
+    static const unsigned PAGE_BITS = 8;
+    static const unsigned PAGE_WORDS = 1u << PAGE_BITS;
+    static const unsigned PAGE_MASK = PAGE_WORDS - 1;
+
+    // Memory of 1 << addr_bits words, addr_bits at most 32
+    explicit PagedMemory(unsigned addr_bits);
+    PagedMemory(const PagedMemory&) = delete;
+    PagedMemory& operator=(const PagedMemory&) = delete;
+
+    uint64_t size() const { return words; } // In words
+    uint64_t pages() const { return (words + PAGE_MASK) >> PAGE_BITS; }
+
+    // addr must be below size(); there is no bounds check
+    uint16_t read(uint64_t addr) const {
+        return page_for_read(addr >> PAGE_BITS)[addr & PAGE_MASK];
+    }
+    void write(uint64_t addr, uint16_t value) {
+        page_for_write(addr >> PAGE_BITS)[addr & PAGE_MASK] = value;
+    }
+
+    const uint16_t* page_for_read(uint64_t page) const {
+        return dir[page >> TABLE_BITS][page & TABLE_MASK];
+    }
+    // Gives the page its own storage if it still shares the zero page
+    uint16_t* page_for_write(uint64_t page) {
+        uint16_t* p = dir[page >> TABLE_BITS][page & TABLE_MASK];
+        return p != zero_page.get() ? p : allocate_page(page);
+    }
+
+    // Copy words to [base, base + count). Returns the number of words
+    // copied, which is less than count if the range runs past size(). Pages
+    // that are still zero stay shared if the words going there are all zero.
+    size_t copy_in(const uint16_t* src, size_t count, uint64_t base);
+
+    // Like copy_in, but every whole page of the range points into src
+    // instead of being copied; only a partial first and last page are
+    // copied. Writes to those pages go to src, which must stay valid until
+    // the pages are replaced by another map or by clear().
+    size_t map(uint16_t* src, size_t count, uint64_t base);
+
+    // Drop all contents. Allocated pages go back to the pool.
+    void clear();
+
+    // Pages that do not share the zero page (allocated or mapped), in
+    // ascending order. Only tables of written regions are visited.
+    std::vector<uint64_t> resident_pages() const;
+
+    // Footprint
+    size_t allocated_pages() const { return allocated; } // Written pages with own storage
+    size_t mapped_pages() const { return mapped; }       // Pages pointing into mapped words
+    size_t resident_bytes() const;                       // Pool, tables and zero page
+
+private:
+    static const unsigned TABLE_BITS = 10;
+    static const unsigned TABLE_SIZE = 1u << TABLE_BITS;
+    static const unsigned TABLE_MASK = TABLE_SIZE - 1;
+    static const unsigned POOL_CHUNK_PAGES = 16;
+
+    uint16_t* allocate_page(uint64_t page);
+    uint16_t** table_for_write(uint64_t page);
+    uint16_t* take_pool_page();
+    bool owns(const uint16_t* page) const;
+
+    uint64_t words;
+    std::unique_ptr<uint16_t[]> zero_page;
+    // Every directory entry starts out as zero_table, whose entries all
+    // point to zero_page; tables are only allocated for written regions.
+    std::unique_ptr<uint16_t*[]> zero_table;
+    std::vector<uint16_t**> dir;
+    std::vector<std::unique_ptr<uint16_t*[]>> tables;
+    std::vector<std::unique_ptr<uint16_t[]>> chunks;
+    std::vector<uint16_t*> free_pages;
+    size_t allocated;
+    size_t mapped;
+};
+
+#endif // PAGED_MEMORY_H
@@ -0,0 +1,234 @@
+#include "pipeline.h"
+#include "alu.h"
+#include "trace_log.h"
+#include <iomanip>
+
+Pipeline::Pipeline(InstructionMemory& imem, RegisterFile& regfile, DataMemory& dmem) :
+    profiler(nullptr), dcache(nullptr), predictor(nullptr), imem(imem), regfile(regfile), dmem(&dmem), bus(nullptr), bus_port(0) {
+    reset(0);
+}
+
+void Pipeline::reset(unsigned start_pc, uint64_t limit) {
+    if_id = id_ex = ex_mem = mem_wb = Slot();
+    pc = start_pc & ADDR_MASK;
+    fetching = limit > 0;
+    wfi_pending = false;
+    cycles = 0;
+    instructions = 0;
+    stall_cycles = 0;
+    memory_stall_cycles = 0;
+    bus_stall_cycles = 0;
+    branches = 0;
+    mispredictions = 0;
+    branch_penalty_cycles = 0;
+    memory_wait = 0;
+    fetch_fault = false;
+    forwards_ex_mem = 0;
+    forwards_mem_wb = 0;
+    fetched = 0;
+    fetch_limit = limit;
+}
+
+// Operand for EX: the newest in-flight result for reg, else what ID read
+state_word Pipeline::forward(unsigned reg, state_word value) {
+    // A LOAD in EX/MEM has no value yet, but ID stalled until it moved on
+    if (ex_mem.valid && ex_mem.c.reg_write && ex_mem.insn.rd == reg) {
+        ++forwards_ex_mem;
+        return ex_mem.value;
+    }
+    if (mem_wb.valid && mem_wb.c.reg_write && mem_wb.insn.rd == reg) {
+        ++forwards_mem_wb;
+        return mem_wb.value;
+    }
+    return value;
+}
+
+bool Pipeline::clock() {
+    ++cycles;
+    if (memory_wait > 0) {
+        --memory_wait;
+        ++memory_stall_cycles;
+        if (profiler) {
+            profiler->count_cycle(false, false);
+        }
+        return true;
+    }
+    if (bus && ex_mem.valid && (ex_mem.c.mem_read || ex_mem.c.mem_write)) {
+        if (!bus->take_grant(bus_port)) {
+            bus->request(bus_port);
+            ++bus_stall_cycles;
+            if (profiler) {
+                profiler->count_cycle(false, false);
+            }
+            return true;
+        }
+        // The rest of the transfer comes after this cycle's access
+        memory_wait = bus->transfer_cycles - 1;
+    }
+
+    // The stages run last to first, so each still sees what its successor
+    // held during the previous cycle, as the pipeline registers would.
+
+    // WB
+    if (mem_wb.valid) {
+        if (mem_wb.c.reg_write) {
+            regfile.write(mem_wb.insn.rd, mem_wb.value);
+        }
+        ++instructions;
+        if (profiler) {
+            profiler->count_instruction(mem_wb.insn);
+        }
+        if (mem_wb.c.halt) {
+            SC_REPORT_INFO("ControlUnit", "HALT instruction encountered. Stopping simulation.");
+        }
+    }
+
+    // MEM
+    Slot to_wb = ex_mem;
+    if (ex_mem.valid) {
+        if (dcache && (ex_mem.c.mem_read || ex_mem.c.mem_write)) {
+            memory_wait += dcache->access(ex_mem.insn.immediate & DATA_ADDR_MASK, ex_mem.c.mem_write);
+        }
+        if (ex_mem.c.mem_write) {
+            dmem->write_word(ex_mem.insn.immediate, ex_mem.a);
+        }
+        if (ex_mem.c.mem_read) {
+            to_wb.value = dmem->read_word(ex_mem.insn.immediate);
+        }
+    }
+
+    // EX
+    Slot to_mem = id_ex;
+    if (id_ex.valid) {
+        if (id_ex.c.reads_rs1) {
+            to_mem.a = forward(id_ex.insn.rs1, id_ex.a);
+        }
+        if (id_ex.c.reads_rs2) {
+            to_mem.b = forward(id_ex.insn.rs2, id_ex.b);
+        }
+        to_mem.value = ALU::compute(id_ex.c.alu_control, to_mem.a, to_mem.b);
+    }
+    bool flush = false;
+    unsigned redirect = 0;
+    if (id_ex.valid && id_ex.c.branch != BRANCH_NEVER && id_ex.c.branch != BRANCH_ALWAYS) {
+        const DecodedInstruction& insn = id_ex.insn;
+        bool taken = ControlUnit::takes_branch(id_ex.c.branch, to_mem.a);
+        ++branches;
+        if (predictor) {
+            predictor->resolve(insn.addr, insn.target, id_ex.prediction, id_ex.predicted_taken, taken,
+                               MISPREDICT_PENALTY);
+        }
+        if (taken != id_ex.predicted_taken) {
+            ++mispredictions;
+            branch_penalty_cycles += MISPREDICT_PENALTY;
+            flush = true;
+            redirect = taken ? insn.target : (insn.addr + 1) & ADDR_MASK;
+        }
+    }
+
+    // ID, after WB has written the register file
+    Slot to_ex;
+    bool stall = false;
+    if (if_id.valid && !flush) {
+        ControlSignals c = ControlUnit::control_for(if_id.insn);
+        stall = id_ex.valid && id_ex.c.mem_read &&
+                ((c.reads_rs1 && id_ex.insn.rd == if_id.insn.rs1) ||
+                 (c.reads_rs2 && id_ex.insn.rd == if_id.insn.rs2));
+        if (stall) {
+            ++stall_cycles;
+        } else {
+            if (!c.known) {
+                SC_REPORT_WARNING("ControlUnit", ("Unknown opcode: " + sc_uint<4>(if_id.insn.opcode).to_string(SC_BIN)).c_str());
+            }
+            to_ex = if_id;
+            to_ex.c = c;
+            to_ex.a = regfile.read(if_id.insn.rs1);
+            to_ex.b = regfile.read(if_id.insn.rs2);
+        }
+    }
+    if (profiler) {
+        profiler->count_cycle(false, !stall);
+    }
+
+    // IF, held along with IF/ID while ID stalls
+    Slot to_id = if_id;
+    if (flush) {
+        // Drop the wrong path: what IF/ID holds, and this cycle's fetch
+        to_id = Slot();
+        if (if_id.valid) {
+            --fetched;
+        }
+        pc = redirect;
+        fetching = fetched < fetch_limit;
+        wfi_pending = false;
+        fetch_fault = false;
+    } else if (!stall) {
+        to_id = Slot();
+        if (fetching) {
+            const DecodedInstruction& insn = imem.decoded[pc];
+            if (!insn.valid) {
+                // Maybe on a mispredicted path; only an error if nothing squashes it
+                fetching = false;
+                fetch_fault = true;
+            } else {
+                TRACE_ACCESS(TRACE_FETCH, TRACE_ACCESSES, false, pc, insn.raw);
+                to_id.valid = true;
+                to_id.insn = insn;
+                ++fetched;
+                // Nothing after a HALT is fetched, and pc stays on it
+                if (insn.opcode == HALT) {
+                    fetching = false;
+                } else {
+                    if (insn.opcode == JMP) {
+                        to_id.predicted_taken = true;
+                    } else if ((insn.opcode == BEQZ || insn.opcode == BNEZ) && predictor) {
+                        to_id.prediction = predictor->snapshot();
+                        to_id.predicted_taken = predictor->predict(pc, insn.target);
+                    }
+                    pc = to_id.predicted_taken ? insn.target : (pc + 1) & ADDR_MASK;
+                    fetching = fetched < fetch_limit;
+                    if (insn.opcode == WFI && fetching) {
+                        fetching = false;
+                        wfi_pending = true;
+                    }
+                }
+            }
+        }
+    }
+
+    mem_wb = to_wb;
+    ex_mem = to_mem;
+    id_ex = to_ex;
+    if_id = to_id;
+    if (fetch_fault && empty()) {
+        SC_REPORT_ERROR("InstructionMemory", "Address out of bounds!");
+        fetch_fault = false;
+    }
+    return fetching || wfi_pending || !empty();
+}
+
+void Pipeline::wake() {
+    wfi_pending = false;
+    fetching = true; // Only set pending while under the fetch limit
+}
+
+void Pipeline::use_shared_memory(DataMemory& memory, SharedBus& shared_bus, unsigned port) {
+    dmem = &memory;
+    bus = &shared_bus;
+    bus_port = port;
+}
+
+void Pipeline::dump(std::ostream& os) const {
+    os << "Pipeline: " << instructions << " instructions in " << cycles << " cycles, CPI "
+       << std::fixed << std::setprecision(3) << cpi() << std::endl;
+    os << "  Load-use stall cycles: " << stall_cycles << ", memory stall cycles: " << memory_stall_cycles << std::endl;
+    os << "  Forwarded operands: " << forwards_ex_mem << " from EX/MEM, "
+       << forwards_mem_wb << " from MEM/WB" << std::endl;
+    if (branches > 0) {
+        os << "  Branches: " << branches << ", " << mispredictions << " mispredicted, "
+           << branch_penalty_cycles << " penalty cycles" << std::endl;
+    }
+    if (bus) {
+        os << "  Bus stall cycles: " << bus_stall_cycles << std::endl;
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <cstdint>
+#include <iostream>
+#include "common.h"
+#include "decoder.h"
+#include "control_unit.h"
+#include "instruction_memory.h"
+#include "register_file.h"
+#include "data_memory.h"
+#include "profiler.h"
+#include "cache.h"
+#include "shared_bus.h"
+#include "branch_predictor.h"
+
+// Five-stage in-order pipeline (IF, ID, EX, MEM, WB) over the datapath
+// modules of a SimpleCPU, driven by its PIPELINED mode one clock edge at a
+// time. Each stage uses the same logic as the single-cycle datapath
+// (ControlUnit::control_for, ALU::compute, RegisterFile and DataMemory
+// access) and hands its result to the next through a pipeline register.
+//
+// The register file is written in the first half of a cycle and read in the
+// second, so WB never conflicts with ID. EX takes its operands from the
+// EX/MEM or MEM/WB register when an older instruction still in flight writes
+// them. A LOAD's value only exists after MEM, so an instruction that uses it
+// right after the LOAD is held in ID for one cycle (a load-use stall).
+//
+// IF predicts conditional branches with predictor (not taken without one)
+// and follows jumps and predicted-taken branches at once, their targets
+// being predecoded. Branches resolve in EX; a misprediction squashes the
+// two younger instructions in IF/ID and ID and fetches the right path on
+// the next edge, MISPREDICT_PENALTY cycles lost. A WFI stops fetching
+// until it has retired and the CPU has seen the interrupt (see waiting and
+// wake). With a data cache, a
+// LOAD or STORE that misses holds the whole pipeline for the miss penalty.
+// On a SharedBus, MEM likewise holds the pipeline until the bus grants it
+// the access (see use_shared_memory).
+class Pipeline {
+public:
+    // Contents of one pipeline register. a and b are the source operands
+    // (a is also the value a STORE writes), value is the ALU result after
+    // EX and the value to write back after MEM.
+    struct Slot {
+        bool valid; // False for a bubble
+        bool predicted_taken; // Where IF went after this branch
+        unsigned prediction;  // predictor->snapshot() it was predicted from
+        DecodedInstruction insn;
+        ControlSignals c;
+        state_word a, b;
+        state_word value;
+
+        Slot() : valid(false), predicted_taken(false), prediction(0), c(), a(0), b(0), value(0) {}
+    };
+
+    Slot if_id, id_ex, ex_mem, mem_wb;
+    unsigned pc;     // Next instruction to fetch
+    bool fetching;   // Cleared by a HALT, the fetch limit or a fetch past the program
+    bool wfi_pending; // Fetching stopped at a WFI, until wake()
+    Profiler* profiler; // Optional, counts retired instructions and stalls
+    Cache* dcache;      // Optional, looked up by MEM
+    BranchPredictor* predictor; // Optional, asked by IF and trained by EX
+
+    static const unsigned MISPREDICT_PENALTY = 2;
+
+    // Counters since the last reset()
+    uint64_t cycles;          // Clock edges out of reset
+    uint64_t instructions;    // Retired in WB
+    uint64_t stall_cycles;    // Load-use stalls
+    uint64_t memory_stall_cycles; // Waiting for dcache misses and multi-cycle bus transfers
+    uint64_t bus_stall_cycles;    // Waiting for a SharedBus grant
+    uint64_t branches;            // Conditional branches resolved
+    uint64_t mispredictions;
+    uint64_t branch_penalty_cycles;
+    uint64_t forwards_ex_mem; // Operands taken from EX/MEM
+    uint64_t forwards_mem_wb; // Operands taken from MEM/WB
+
+    Pipeline(InstructionMemory& imem, RegisterFile& regfile, DataMemory& dmem);
+
+    // Empty the pipeline and fetch from start_pc next. At most
+    // fetch_limit instructions are fetched, so the pipeline drains and
+    // stops with exactly that many retired.
+    void reset(unsigned start_pc, uint64_t fetch_limit = UINT64_MAX);
+
+    // One rising clock edge: every stage advances by one. Returns false once
+    // fetching has stopped and the last instruction has been written back;
+    // the architectural state is then exact, with pc the next instruction.
+    bool clock();
+
+    // Do MEM's accesses in memory instead, as port of bus
+    void use_shared_memory(DataMemory& memory, SharedBus& bus, unsigned port);
+
+    // Everything up to a WFI has retired; fetching resumes after wake()
+    bool waiting() const { return wfi_pending && empty(); }
+    void wake();
+
+    bool empty() const { return !if_id.valid && !id_ex.valid && !ex_mem.valid && !mem_wb.valid; }
+    double cpi() const { return instructions > 0 ? static_cast<double>(cycles) / instructions : 0.0; }
+    void dump(std::ostream& os) const;
+
+private:
+    InstructionMemory& imem;
+    RegisterFile& regfile;
+    DataMemory* dmem;
+    SharedBus* bus;
+    unsigned bus_port;
+    uint64_t fetched;
+    uint64_t fetch_limit;
+    unsigned memory_wait; // Cycles left of the current dcache miss
+    bool fetch_fault;     // Fetched past the program, reported once drained unless squashed
+
+    state_word forward(unsigned reg, state_word value);
+};
+
+#endif // PIPELINE_H
@@ -0,0 +1,81 @@
+#include "profiler.h"
+#include <algorithm>
+#include <iomanip>
+#include <string>
+#include <utility>
+
+static const char* opcode_name(unsigned opcode) {
+    switch (opcode) {
+        case LOAD:  return "LOAD";
+        case STORE: return "STORE";
+        case ADD:   return "ADD";
+        case SUB:   return "SUB";
+        case HALT:  return "HALT";
+        case WFI:   return "WFI";
+        case BEQZ:  return "BEQZ";
+        case BNEZ:  return "BNEZ";
+        case JMP:   return "JMP";
+        default:    return "unknown";
+    }
+}
+
+// Print the non-zero entries of counts, highest first
+static void dump_histogram(std::ostream& os, const char* title, const char* key,
+                           const uint64_t* counts, size_t size, size_t top, bool opcodes) {
+    std::vector<std::pair<uint64_t, size_t>> entries;
+    uint64_t total = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (counts[i] > 0) {
+            entries.push_back(std::make_pair(counts[i], i));
+            total += counts[i];
+        }
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const std::pair<uint64_t, size_t>& a, const std::pair<uint64_t, size_t>& b) {
+                  return a.first != b.first ? a.first > b.first : a.second < b.second;
+              });
+
+    os << title << " (" << entries.size() << " distinct, " << total << " total)" << std::endl;
+    for (size_t i = 0; i < entries.size() && i < top; ++i) {
+        os << "  " << key << " ";
+        if (opcodes) {
+            os << std::left << std::setw(8) << opcode_name(entries[i].second) << std::right;
+        } else {
+            os << std::setw(8) << entries[i].second;
+        }
+        os << std::setw(14) << entries[i].first
+           << std::setw(9) << std::fixed << std::setprecision(2)
+           << 100.0 * entries[i].first / total << "%" << std::endl;
+    }
+}
+
+Profiler::Profiler(unsigned addr_size) : pc_counts(1 << addr_size), data_counts(1 << addr_size) {
+    clear();
+}
+
+uint64_t Profiler::instructions() const {
+    uint64_t total = 0;
+    for (int i = 0; i < 16; ++i) {
+        total += opcode_counts[i];
+    }
+    return total;
+}
+
+void Profiler::clear() {
+    std::fill(pc_counts.begin(), pc_counts.end(), 0);
+    std::fill(opcode_counts, opcode_counts + 16, 0);
+    std::fill(data_counts.begin(), data_counts.end(), 0);
+    cycles = 0;
+    idle_cycles = 0;
+    stall_cycles = 0;
+    waiting_cycles = 0;
+}
+
+void Profiler::dump(std::ostream& os, size_t top) const {
+    os << "Profile: " << instructions() << " instructions, " << cycles << " cycles ("
+       << idle_cycles << " idle, " << stall_cycles << " stalled), "
+       << waiting_cycles << " waiting for interrupts" << std::endl;
+    dump_histogram(os, "Executions per PC", "pc", pc_counts.data(), pc_counts.size(), top, false);
+    dump_histogram(os, "Executions per opcode", "op", opcode_counts, 16, top, true);
+    dump_histogram(os, "Accesses per data address", "addr", data_counts.data(), data_counts.size(), top, false);
+}
@@ -0,0 +1,62 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "common.h"
+#include "decoder.h"
+
+// Always-on execution profile of a SimpleCPU: executions per PC and per
+// opcode, LOAD/STORE accesses per data address, and clock cycles spent in
+// reset (idle) or with the PC held (stalled). Clock periods spent asleep in
+// a WFI are skipped rather than clocked, and counted apart. The count_*
+// hooks are plain array increments so the profiler can stay enabled in
+// production runs.
+class Profiler {
+public:
+    std::vector<uint64_t> pc_counts;    // 1 << addr_size entries
+    uint64_t opcode_counts[16];
+    std::vector<uint64_t> data_counts;  // 1 << addr_size entries
+    uint64_t cycles;
+    uint64_t idle_cycles;
+    uint64_t stall_cycles;
+    uint64_t waiting_cycles; // Asleep in WFI, not part of cycles
+
+    // addr_size is the ADDR_SIZE of the CpuConfig being profiled
+    explicit Profiler(unsigned addr_size = ADDR_SIZE);
+
+    // Called by ControlUnit::decode and FunctionalCore::step
+    void count_instruction(const DecodedInstruction& insn) {
+        if (!insn.valid) {
+            return;
+        }
+        ++pc_counts[insn.addr];
+        ++opcode_counts[insn.opcode];
+        if (insn.opcode == LOAD || insn.opcode == STORE) {
+            ++data_counts[insn.immediate];
+        }
+    }
+
+    // Called by ProgramCounter on every rising clock edge
+    void count_cycle(bool reset, bool enable) {
+        ++cycles;
+        if (reset) {
+            ++idle_cycles;
+        } else if (!enable) {
+            ++stall_cycles;
+        }
+    }
+
+    // Called once per WFI with the clock periods it slept through
+    void count_wait(uint64_t periods) {
+        waiting_cycles += periods;
+    }
+
+    uint64_t instructions() const;
+    void clear();
+    // Print the counters as histograms sorted by count, at most top rows each
+    void dump(std::ostream& os, size_t top = 16) const;
+};
+
+#endif // PROFILER_H
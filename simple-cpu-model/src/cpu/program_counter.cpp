@@ -1,13 +1,33 @@
 #include "program_counter.h"
+#include "sim_stats.h"
 
 
 void ProgramCounter::increment() {
     while (true) {
         wait(clk.posedge_event()); // Wait for the rising edge of the clock
+        ++SimStats::process_activations;
+        if (!reset.read() && wait_for_interrupt.read() && !irq.read()) {
+            sc_time start = sc_time_stamp();
+            wait(irq.posedge_event());
+            wait(clk.posedge_event());
+            ++SimStats::process_activations;
+            if (profiler) {
+                // From the edge that found the WFI to the one before this,
+                // which counts below
+                profiler->count_wait(static_cast<uint64_t>((sc_time_stamp() - start) / period + 0.5));
+            }
+        }
+        if (profiler) {
+            profiler->count_cycle(reset.read(), enable.read());
+        }
         if (reset.read()) {
-            pc = 0;
+            pc = reset_address;
         } else if (enable.read()) {
-            pc++;
+            if (branch_taken.read()) {
+                pc = branch_target.read();
+            } else {
+                pc++;
+            }
         }
         current_address.write(pc);
     }
@@ -3,17 +3,29 @@
 
 #include "systemc.h"
 #include "common.h"
+#include "profiler.h"
+// While the current instruction is a WFI and irq is low, the PC stops
+// waiting for clock edges: it sleeps until irq rises and resumes on the
+// next edge, so idle time costs no process activations. A taken branch or
+// jump loads its target instead of incrementing.
 SC_MODULE(ProgramCounter) {
     sc_in_clk clk;
     sc_in<bool> reset;
     sc_in<bool> enable;
+    sc_in<bool> wait_for_interrupt;
+    sc_in<bool> irq;
+    sc_in<bool> branch_taken;
+    sc_in<address> branch_target;
     sc_out<address> current_address;
 
     address pc;
+    address reset_address; // Where execution starts, 0 unless restored from a checkpoint
+    Profiler* profiler;    // Optional, counts cycles
+    sc_time period;        // Of clk, to count the cycles slept through
 
     void increment();
 
-    SC_CTOR(ProgramCounter) : pc(0) {
+    SC_CTOR(ProgramCounter) : pc(0), reset_address(0), profiler(nullptr), period(10, SC_NS) {
         SC_THREAD(increment);
         sensitive << clk.pos() << reset.pos();
         dont_initialize();
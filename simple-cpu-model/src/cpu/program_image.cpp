@@ -0,0 +1,148 @@
+#include "program_image.h"
+#include "byte_order.h"
+#include <systemc.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const size_t HEADER_BYTES = 8;
+static const size_t DESCRIPTOR_BYTES = 16;
+
+ProgramImage::ProgramImage() : base(nullptr), size(0) {}
+
+ProgramImage::~ProgramImage() {
+    close();
+}
+
+bool ProgramImage::open(const std::string& path, SegmentKind raw_kind) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        SC_REPORT_ERROR("ProgramImage", ("Cannot open " + path + ": " + std::strerror(errno)).c_str());
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        SC_REPORT_ERROR("ProgramImage", ("Empty or unreadable image " + path).c_str());
+        return false;
+    }
+    size = st.st_size;
+    base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        base = nullptr;
+        size = 0;
+        SC_REPORT_ERROR("ProgramImage", ("Cannot map " + path + ": " + std::strerror(errno)).c_str());
+        return false;
+    }
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(base);
+    bool ok;
+    if (size >= HEADER_BYTES && std::memcmp(bytes, "SCPU", 4) == 0) {
+        ok = parse_container(path);
+    } else {
+        Segment seg = { raw_kind, 0, static_cast<uint16_t*>(base), size / sizeof(uint16_t) };
+        segs.push_back(seg);
+        ok = true;
+    }
+    if (!ok) {
+        close();
+        return false;
+    }
+
+    // Words are stored little-endian; fix them up in the private mapping
+    if (!host_is_little_endian()) {
+        for (const Segment& seg : segs) {
+            for (size_t i = 0; i < seg.word_count; ++i) {
+                seg.words[i] = static_cast<uint16_t>((seg.words[i] >> 8) | (seg.words[i] << 8));
+            }
+        }
+    }
+    return true;
+}
+
+bool ProgramImage::parse_container(const std::string& path) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(base);
+    uint16_t version = read_le16(bytes + 4);
+    uint16_t count = read_le16(bytes + 6);
+    if (version != 1 || HEADER_BYTES + count * DESCRIPTOR_BYTES > size) {
+        SC_REPORT_ERROR("ProgramImage", ("Bad container header in " + path).c_str());
+        return false;
+    }
+    for (unsigned i = 0; i < count; ++i) {
+        const uint8_t* d = bytes + HEADER_BYTES + i * DESCRIPTOR_BYTES;
+        uint16_t kind = read_le16(d);
+        uint32_t load_address = read_le32(d + 4);
+        uint32_t offset = read_le32(d + 8);
+        uint32_t word_count = read_le32(d + 12);
+        if (kind > DATA || offset % sizeof(uint16_t) != 0 || offset > size ||
+            word_count > (size - offset) / sizeof(uint16_t)) {
+            SC_REPORT_ERROR("ProgramImage", ("Bad segment descriptor in " + path).c_str());
+            return false;
+        }
+        Segment seg = { static_cast<SegmentKind>(kind), load_address,
+                        reinterpret_cast<uint16_t*>(static_cast<uint8_t*>(base) + offset), word_count };
+        segs.push_back(seg);
+    }
+    return true;
+}
+
+void ProgramImage::close() {
+    if (base != nullptr) {
+        munmap(base, size);
+    }
+    base = nullptr;
+    size = 0;
+    segs.clear();
+}
+
+const ProgramImage::Segment* ProgramImage::find(SegmentKind kind) const {
+    for (const Segment& seg : segs) {
+        if (seg.kind == kind) {
+            return &seg;
+        }
+    }
+    return nullptr;
+}
+
+bool ProgramImage::write(const std::string& path, const std::vector<uint16_t>& program,
+                         const std::vector<uint16_t>& data) {
+    std::vector<uint8_t> out;
+    out.insert(out.end(), { 'S', 'C', 'P', 'U' });
+    write_le16(out, 1);
+    write_le16(out, 2);
+
+    const uint32_t program_offset = HEADER_BYTES + 2 * DESCRIPTOR_BYTES;
+    const uint32_t data_offset = program_offset + program.size() * sizeof(uint16_t);
+    write_le16(out, PROGRAM);
+    write_le16(out, 0);
+    write_le32(out, 0);
+    write_le32(out, program_offset);
+    write_le32(out, program.size());
+    write_le16(out, DATA);
+    write_le16(out, 0);
+    write_le32(out, 0);
+    write_le32(out, data_offset);
+    write_le32(out, data.size());
+    for (uint16_t w : program) {
+        write_le16(out, w);
+    }
+    for (uint16_t w : data) {
+        write_le16(out, w);
+    }
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (f == nullptr) {
+        SC_REPORT_ERROR("ProgramImage", ("Cannot create " + path).c_str());
+        return false;
+    }
+    bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+    ok = std::fclose(f) == 0 && ok;
+    return ok;
+}
@@ -0,0 +1,61 @@
+#ifndef PROGRAM_IMAGE_H
+#define PROGRAM_IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A program/data image file mapped into memory with mmap. Two formats are
+// accepted, both little-endian:
+//
+//  - raw: the whole file is a sequence of 16-bit words, loaded at address 0
+//    as the segment kind passed to open();
+//  - container: an 8-byte header, "SCPU", uint16 version (1), uint16 segment
+//    count, followed by one 16-byte descriptor per segment: uint16 kind
+//    (0 program, 1 data), uint16 reserved, uint32 load address in words,
+//    uint32 file offset in bytes, uint32 word count.
+//
+// The mapping is private and writable, so segments can be used in place
+// (writes never reach the file) or copied out in bulk.
+class ProgramImage {
+public:
+    enum SegmentKind {
+        PROGRAM = 0,
+        DATA = 1
+    };
+
+    struct Segment {
+        SegmentKind kind;
+        uint32_t load_address; // In words
+        uint16_t* words;       // Points into the mapping
+        size_t word_count;
+    };
+
+    ProgramImage();
+    ~ProgramImage();
+    ProgramImage(const ProgramImage&) = delete;
+    ProgramImage& operator=(const ProgramImage&) = delete;
+
+    // Map path. raw_kind is the segment kind of a raw (headerless) file.
+    // Reports an error and returns false on failure.
+    bool open(const std::string& path, SegmentKind raw_kind = PROGRAM);
+    void close();
+
+    const std::vector<Segment>& segments() const { return segs; }
+    const Segment* find(SegmentKind kind) const;
+
+    // Write a container image with one program and one data segment, both
+    // loaded at address 0
+    static bool write(const std::string& path, const std::vector<uint16_t>& program,
+                      const std::vector<uint16_t>& data);
+
+private:
+    bool parse_container(const std::string& path);
+
+    void* base;
+    size_t size;
+    std::vector<Segment> segs;
+};
+
+#endif // PROGRAM_IMAGE_H
@@ -1,14 +1,23 @@
 #include "register_file.h"
+#include "sim_stats.h"
+#include "trace_log.h"
 
 void RegisterFile::read_registers() {
-    read_data1.write(registers[read_reg1_addr.read()]);
-    read_data2.write(registers[read_reg2_addr.read()]);
+    ++SimStats::process_activations;
+    read_data1.write(read(read_reg1_addr.read().to_uint()));
+    read_data2.write(read(read_reg2_addr.read().to_uint()));
 }
 
 void RegisterFile::write_register() {
+    ++SimStats::process_activations;
     if (write_enable.read()) {
-        registers[write_reg_addr.read()] = write_data.read();
-        SC_REPORT_INFO("RegisterFile", ("Wrote " + write_data.read().to_string() + " to register " + write_reg_addr.read().to_string()).c_str());
+        write(write_reg_addr.read().to_uint(), write_data.read().to_uint());
     }
 
 }
+
+void RegisterFile::write(unsigned index, unsigned value) {
+    index %= NUM_REGISTERS;
+    registers[index] = mask_word(value);
+    TRACE_ACCESS(TRACE_REGISTER_FILE, TRACE_WRITES, true, index, registers[index]);
+}
@@ -13,11 +13,18 @@ SC_MODULE(RegisterFile)
     sc_in<bool> write_enable;
     sc_out<word> read_data1, read_data2;
 
-    word registers[NUM_REGISTERS];
+    state_word registers[NUM_REGISTERS];
 
     void write_register();
     void read_registers();
 
+    // Direct access, as used by the processes above and the levelized
+    // datapath. Indices wrap at NUM_REGISTERS; writes are masked and traced.
+    state_word read(unsigned index) const {
+        return registers[index % NUM_REGISTERS];
+    }
+    void write(unsigned index, unsigned value);
+
     SC_CTOR(RegisterFile) {
         SC_METHOD(read_registers);
         sensitive << read_reg1_addr << read_reg2_addr;
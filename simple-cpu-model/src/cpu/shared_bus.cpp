@@ -0,0 +1,98 @@
+#include "shared_bus.h"
+#include "sim_stats.h"
+#include <iomanip>
+
+SharedBus::SharedBus(sc_module_name name, unsigned ports, ArbitrationPolicy policy, unsigned transfer_cycles) :
+    sc_module(name),
+    ports(ports > 0 ? ports : 1),
+    policy(policy),
+    transfer_cycles(transfer_cycles > 0 ? transfer_cycles : 1),
+    cycles(0),
+    busy_cycles(0),
+    requests(this->ports),
+    wait_cycles(this->ports),
+    queue_depth(this->ports + 1),
+    pending(this->ports),
+    granted(this->ports),
+    done(this->ports),
+    next_port(0),
+    busy_left(0),
+    running(this->ports)
+{
+    SC_METHOD(arbitrate);
+    sensitive << clk.neg();
+    dont_initialize();
+}
+
+void SharedBus::request(unsigned port) {
+    if (!pending[port] && !granted[port]) {
+        pending[port] = true;
+        ++requests[port];
+    }
+}
+
+bool SharedBus::take_grant(unsigned port) {
+    if (!granted[port]) {
+        return false;
+    }
+    granted[port] = false;
+    return true;
+}
+
+void SharedBus::finished(unsigned port) {
+    if (!done[port]) {
+        done[port] = true;
+        if (--running == 0) {
+            SC_REPORT_INFO("SharedBus", "All cores finished. Stopping simulation.");
+            sc_stop();
+        }
+    }
+}
+
+void SharedBus::arbitrate() {
+    ++SimStats::process_activations;
+    if (running == 0) {
+        return;
+    }
+    ++cycles;
+    unsigned depth = 0;
+    for (unsigned p = 0; p < ports; ++p) {
+        depth += pending[p];
+    }
+    ++queue_depth[depth];
+
+    if (busy_left > 0) {
+        --busy_left;
+        ++busy_cycles;
+    } else if (depth > 0) {
+        unsigned port = policy == ARBITRATE_PRIORITY ? 0 : next_port;
+        while (!pending[port]) {
+            port = (port + 1) % ports;
+        }
+        pending[port] = false;
+        granted[port] = true;
+        next_port = (port + 1) % ports;
+        busy_left = transfer_cycles - 1;
+        ++busy_cycles;
+    }
+
+    for (unsigned p = 0; p < ports; ++p) {
+        wait_cycles[p] += pending[p];
+    }
+}
+
+void SharedBus::dump(std::ostream& os) const {
+    os << "Shared bus: " << ports << " ports, "
+       << (policy == ARBITRATE_PRIORITY ? "priority" : "round-robin") << ", "
+       << transfer_cycles << " cycles per transfer, utilization " << std::fixed << std::setprecision(2)
+       << 100.0 * utilization() << "% of " << cycles << " cycles" << std::endl;
+    for (unsigned p = 0; p < ports; ++p) {
+        os << "  Port " << p << ": " << requests[p] << " requests, "
+           << wait_cycles[p] << " cycles waiting for another port" << std::endl;
+    }
+    os << "  Pending requests per cycle:";
+    for (unsigned d = 0; d <= ports; ++d) {
+        os << " " << d << ":" << queue_depth[d];
+    }
+    os << std::endl;
+}
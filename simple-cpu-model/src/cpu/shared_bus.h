@@ -0,0 +1,56 @@
+#ifndef SHARED_BUS_H
+#define SHARED_BUS_H
+
+#include <systemc.h>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+enum ArbitrationPolicy {
+    ARBITRATE_ROUND_ROBIN, // The port after the last one granted goes first
+    ARBITRATE_PRIORITY     // The lowest-numbered requesting port wins
+};
+
+// Cycle-level arbiter for the data memory shared by the cores of a
+// MultiCoreSystem. Each core is one port. A core whose MEM stage holds a
+// LOAD or STORE calls request() on a rising clock edge and stalls; on the
+// falling edge the bus grants one pending request, and the core performs the
+// access on the next rising edge when take_grant() returns true. A grant
+// keeps the bus busy for transfer_cycles cycles. Requests wait in place, so
+// an access costs at least one cycle of arbitration even without contention.
+SC_MODULE(SharedBus) {
+    sc_in_clk clk;
+
+    const unsigned ports;
+    const ArbitrationPolicy policy;
+    const unsigned transfer_cycles;
+
+    // Counters, per port where indexed
+    uint64_t cycles;                  // Arbitration rounds
+    uint64_t busy_cycles;             // Cycles with a transfer in progress
+    std::vector<uint64_t> requests;   // Accesses requested
+    std::vector<uint64_t> wait_cycles; // Cycles spent requesting without a grant
+    std::vector<uint64_t> queue_depth; // Rounds by number of pending requests, 0 to ports
+
+    SC_HAS_PROCESS(SharedBus);
+    SharedBus(sc_module_name name, unsigned ports, ArbitrationPolicy policy, unsigned transfer_cycles = 1);
+
+    void request(unsigned port);
+    // True once per grant; the caller then performs its access
+    bool take_grant(unsigned port);
+    // The core on port has drained; the simulation stops when all have
+    void finished(unsigned port);
+
+    double utilization() const { return cycles > 0 ? static_cast<double>(busy_cycles) / cycles : 0.0; }
+    void dump(std::ostream& os) const;
+
+private:
+    std::vector<bool> pending, granted, done;
+    unsigned next_port;  // Round-robin pointer
+    unsigned busy_left;  // Cycles until the bus can grant again
+    unsigned running;    // Cores not finished
+
+    void arbitrate();
+};
+
+#endif // SHARED_BUS_H
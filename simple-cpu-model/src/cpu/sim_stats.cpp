@@ -0,0 +1,3 @@
+#include "sim_stats.h"
+
+uint64_t SimStats::process_activations = 0;
@@ -0,0 +1,13 @@
+#ifndef SIM_STATS_H
+#define SIM_STATS_H
+
+#include <cstdint>
+
+// Simulator-level counters read by the benchmark harness. The SystemC kernel
+// does not say how often processes run, so every process of the CPU model
+// counts its own activations here.
+struct SimStats {
+    static uint64_t process_activations;
+};
+
+#endif // SIM_STATS_H
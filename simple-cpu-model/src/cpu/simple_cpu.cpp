@@ -0,0 +1,681 @@
+#include "simple_cpu.h"
+#include "sim_stats.h"
+#include "trace_log.h"
+#include <algorithm>
+#include <sstream>
+
+SimpleCPU::SimpleCPU(sc_module_name name, ExecutionMode mode) :
+    sc_module(name),
+    imem("imem"),
+    dmem("dmem"),
+    pc("pc"),
+    ctrl("ctrl"),
+    regfile("regfile"),
+    alu("alu"),
+    clk_idle("clk_idle", false),
+    pc_addr("pc_addr", address(~0u)), // Undefined until the PC leaves reset
+    reset_sig("reset", true), // Initialize reset high
+    wfi_sig("wfi_sig", false),
+    branch_taken_sig("branch_taken_sig", false),
+    irq("irq", false),
+    data_socket("data_socket"),
+    mode(mode),
+    cycle_time(10, SC_NS),
+    pipeline(imem, regfile, dmem),
+    transport_bus(*this),
+    memory_bus(*this),
+    instruction_limit(UINT64_MAX),
+    quantum_instructions(1),
+    accounted_instructions(0),
+    profile_stream(nullptr),
+    restored_instructions(0),
+    restored_time(SC_ZERO_TIME),
+    dcache_stall_cycles(0),
+    shared_bus(nullptr),
+    bus_port(0),
+    pipeline_drained(false),
+    wfi_pending(false),
+    waiting_for_interrupt(false)
+{
+    pc.profiler = &profiler;
+    ctrl.profiler = &profiler;
+    core.profiler = &profiler;
+    pipeline.profiler = &profiler;
+
+    // Instruction Memory Connections
+    imem.addr_in(pc_addr);
+    imem.instruction_out(instruction);
+    imem.decoded_out(decoded_instruction);
+
+    // Program Counter Connections
+    if (clocked() || mode == PIPELINED) {
+        clk.reset(new sc_clock("clock", cycle_time));
+    }
+    if (mode == SIGNAL_LEVEL) {
+        pc.clk(*clk);
+    } else {
+        pc.clk(clk_idle);
+    }
+    pc.reset(reset_sig);
+    pc.enable(pc_en);
+    pc.current_address(pc_addr);
+    pc.wait_for_interrupt(wfi_sig);
+    pc.irq(irq);
+    pc.branch_taken(branch_taken_sig);
+    pc.branch_target(branch_target_sig);
+    pc.period = cycle_time;
+
+    // Control Unit Connections
+    ctrl.instruction_in(decoded_instruction);
+    ctrl.pc_enable(pc_en);
+    ctrl.mem_read_enable(mem_rd);
+    ctrl.mem_write_enable(mem_wr);
+    ctrl.mem_addr(mem_addr_sig);
+    ctrl.reg_read1_addr(rf_rd1_addr);
+    ctrl.reg_read2_addr(rf_rd2_addr);
+    ctrl.reg_write_addr(rf_wr_addr);
+    ctrl.reg_write_enable(rf_wr_en);
+    ctrl.alu_control(alu_ctrl_sig);
+    ctrl.wait_for_interrupt(wfi_sig);
+    ctrl.branch_operand(rf_rd1_data);
+    ctrl.branch_taken(branch_taken_sig);
+    ctrl.branch_target(branch_target_sig);
+
+    // Register File Connections
+    regfile.read_reg1_addr(rf_rd1_addr);
+    regfile.read_reg2_addr(rf_rd2_addr);
+    regfile.write_reg_addr(rf_wr_addr);
+    regfile.write_data(rf_wr_data_sig);
+    regfile.write_enable(rf_wr_en);
+    regfile.read_data1(rf_rd1_data);
+    regfile.read_data2(rf_rd2_data);
+
+    // ALU Connections
+    alu.operand1(alu_op1);
+    alu.operand2(alu_op2);
+    alu.alu_control(alu_ctrl_sig);
+    alu.result(alu_res);
+
+    // Data Memory Connections
+    dmem.addr_in(mem_addr_sig);
+    dmem.data_in(mem_wr_data_sig);
+    dmem.write_enable(mem_wr);
+    dmem.data_out(mem_rd_data_sig);
+    data_socket.bind(dmem.socket);
+    data_socket.register_invalidate_direct_mem_ptr(this, &SimpleCPU::invalidate_direct_mem_ptr);
+
+    // Connecting data paths based on instruction type
+    SC_METHOD(connect_data_paths);
+    sensitive << decoded_instruction << rf_rd1_data << rf_rd2_data << alu_res << mem_rd_data_sig;
+    dont_initialize();
+
+    if (clocked() || mode == PIPELINED) {
+        // Reset the PC after a short delay
+        SC_THREAD(reset_pc);
+    }
+    if (mode == LEVELIZED) {
+        SC_METHOD(evaluate_datapath);
+        sensitive << clk->posedge_event();
+        dont_initialize();
+    } else if (mode == PIPELINED) {
+        SC_METHOD(clock_pipeline);
+        sensitive << clk->posedge_event();
+        dont_initialize();
+    } else if (mode == FUNCTIONAL_ISS) {
+        SC_THREAD(run_iss);
+    } else if (mode == DECOUPLED_ISS) {
+        set_quantum(1000);
+        SC_THREAD(run_decoupled);
+    }
+}
+
+void SimpleCPU::connect_data_paths() {
+    ++SimStats::process_activations;
+    Opcode opcode = static_cast<Opcode>(decoded_instruction.read().opcode);
+    if (dcache && decoded_instruction.event() && (opcode == LOAD || opcode == STORE)) {
+        access_dcache(decoded_instruction.read().immediate, opcode == STORE);
+    }
+
+    switch (opcode) {
+        case LOAD:
+            rf_wr_data_sig.write(mem_rd_data_sig);
+            break;
+        case STORE:
+            mem_wr_data_sig.write(rf_rd1_data); // Assuming we store the value of rs1
+            break;
+        case ADD:
+        case SUB:
+            alu_op1.write(rf_rd1_data);
+            alu_op2.write(rf_rd2_data);
+            rf_wr_data_sig.write(alu_res);
+            break;
+        case HALT:
+            break;
+        default:
+            break;
+    }
+}
+
+// Called on a clock edge, or off it when irq woke us. Returns true if the
+// edge is not to be evaluated: either we are going to sleep on irq because
+// waiting, or we just woke and resume on the next clock edge.
+bool SimpleCPU::sleep_until_interrupt(bool waiting) {
+    if (waiting_for_interrupt) {
+        // From the edge that found the wait to the last one slept through
+        profiler.count_wait(static_cast<uint64_t>((sc_time_stamp() - wait_start) / cycle_time) + 1);
+        waiting_for_interrupt = false;
+        next_trigger(); // Back to the clock
+        return true;
+    }
+    if (waiting && !irq.read()) {
+        waiting_for_interrupt = true;
+        wait_start = sc_time_stamp();
+        next_trigger(irq.posedge_event());
+        return true;
+    }
+    return false;
+}
+
+void SimpleCPU::evaluate_datapath() {
+    ++SimStats::process_activations;
+    // As in SIGNAL_LEVEL, the edge after a WFI holds the PC until irq is high
+    if (sleep_until_interrupt(wfi_pending && !reset_sig.read())) {
+        wfi_pending = false; // Woken, or irq is already high
+        return;
+    }
+    wfi_pending = false;
+    // ProgramCounter first acts on the clock edge after reset, so the timing
+    // matches SIGNAL_LEVEL: instruction k executes at (k + 1) clock periods
+    profiler.count_cycle(reset_sig.read(), true);
+    if (reset_sig.read()) {
+        return;
+    }
+
+    // Fetch. pc.pc holds the next instruction, as in the ISS modes.
+    unsigned addr = pc.pc.to_uint();
+    const DecodedInstruction& insn = imem.decoded[addr];
+    if (!insn.valid) {
+        SC_REPORT_ERROR("InstructionMemory", "Address out of bounds!");
+        sc_stop();
+        return;
+    }
+    TRACE_ACCESS(TRACE_FETCH, TRACE_ACCESSES, false, addr, insn.raw);
+    ++ctrl.instructions_decoded;
+    profiler.count_instruction(insn);
+
+    // Decode, register read, execute, memory, write-back: what the signal
+    // level datapath does over several delta cycles, in one pass
+    ControlSignals c = ControlUnit::control_for(insn);
+    if (c.halt) {
+        SC_REPORT_INFO("ControlUnit", "HALT instruction encountered. Stopping simulation.");
+        sc_stop();
+        return;
+    }
+    if (!c.known) {
+        SC_REPORT_WARNING("ControlUnit", ("Unknown opcode: " + sc_uint<4>(insn.opcode).to_string(SC_BIN)).c_str());
+    }
+    state_word a = regfile.read(insn.rs1);
+    state_word b = regfile.read(insn.rs2);
+    if (dcache && (c.mem_read || c.mem_write)) {
+        access_dcache(insn.immediate, c.mem_write);
+    }
+    if (c.mem_write) {
+        dmem.write_word(insn.immediate, a);
+    }
+    if (c.reg_write) {
+        state_word value = c.mem_read ? state_word(dmem.read_word(insn.immediate)) : ALU::compute(c.alu_control, a, b);
+        regfile.write(insn.rd, value);
+    }
+    if (c.pc_enable) {
+        pc.pc = ControlUnit::takes_branch(c.branch, a) ? insn.target : (addr + 1) & ADDR_MASK;
+    }
+    wfi_pending = c.wait_for_interrupt;
+}
+
+void SimpleCPU::clock_pipeline() {
+    ++SimStats::process_activations;
+    if (reset_sig.read()) {
+        profiler.count_cycle(true, true);
+        pipeline.reset(pc.reset_address.to_uint(), instruction_limit);
+        return;
+    }
+    if (pipeline_drained) {
+        return; // Other cores on the shared bus are still running
+    }
+    // A WFI has retired and nothing behind it was fetched
+    if (sleep_until_interrupt(pipeline.waiting())) {
+        if (!waiting_for_interrupt) {
+            pipeline.wake(); // Fetch again from the next edge
+        }
+        return;
+    }
+    if (pipeline.waiting()) {
+        pipeline.wake();
+    }
+    pipeline_drained = !pipeline.clock();
+    pc.pc = pipeline.pc;
+    if (pipeline_drained) {
+        if (shared_bus) {
+            shared_bus->finished(bus_port);
+        } else {
+            sc_stop();
+        }
+    }
+}
+
+void SimpleCPU::reset_pc() {
+    ++SimStats::process_activations;
+    wait(5, SC_NS);
+    reset_sig.write(false);
+}
+
+void SimpleCPU::load_core_state() {
+    // Take the architectural state from the datapath modules, so all modes
+    // are loaded and inspected the same way. Data memory is used in place:
+    // its first page directly, the rest through memory_bus. With a data
+    // cache every access has to be seen, so all of it goes through the bus.
+    core.reset();
+    core.pc = pc.reset_address.to_uint();
+    core.load_program(imem.memory, imem.decoded);
+    imem.iss_core = &core;
+    if (dcache) {
+        core.attach_data(nullptr, 0);
+    } else {
+        // Devices must see their accesses, so the window stops below them
+        core.attach_data(dmem.memory.page_for_write(0),
+                         static_cast<unsigned>(std::min<uint64_t>(PagedMemory::PAGE_WORDS, dmem.first_device_address())));
+    }
+    core.bus = &memory_bus;
+    for (int i = 0; i < NUM_REGISTERS; ++i) {
+        core.registers[i] = regfile.registers[i];
+    }
+}
+
+void SimpleCPU::store_core_state() {
+    for (int i = 0; i < NUM_REGISTERS; ++i) {
+        regfile.registers[i] = core.registers[i];
+    }
+    pc.pc = core.pc;
+}
+
+void SimpleCPU::finish_core(FunctionalCore::StopReason reason) {
+    if (reason == FunctionalCore::HALTED) {
+        SC_REPORT_INFO("SimpleCPU", "HALT instruction encountered. Stopping simulation.");
+        sc_stop();
+    } else if (reason == FunctionalCore::RUNNING) {
+        SC_REPORT_INFO("SimpleCPU", "Instruction limit reached. Stopping simulation.");
+        sc_stop();
+    } else {
+        SC_REPORT_ERROR("InstructionMemory", "Address out of bounds!");
+    }
+}
+
+void SimpleCPU::run_iss() {
+    ++SimStats::process_activations;
+    load_core_state();
+    accounted_instructions = core.instructions_executed;
+    FunctionalCore::StopReason reason = core.run(instruction_limit);
+    while (reason == FunctionalCore::WAITING_FOR_INTERRUPT) {
+        sync_core_time();
+        wait_for_interrupt();
+        reason = core.instructions_executed < instruction_limit ? core.run(instruction_limit - core.instructions_executed)
+                                                                : FunctionalCore::RUNNING;
+    }
+    store_core_state();
+    sync_core_time();
+    finish_core(reason);
+}
+
+// One clock period per instruction, as in the signal-level model, plus data
+// cache stalls, for what FUNCTIONAL_ISS has run since the last call
+void SimpleCPU::sync_core_time() {
+    uint64_t cycles = core.instructions_executed - accounted_instructions + dcache_stall_cycles +
+                      core.branch_stall_cycles;
+    accounted_instructions = core.instructions_executed;
+    dcache_stall_cycles = 0;
+    core.branch_stall_cycles = 0;
+    if (cycles > 0) {
+        wait(cycle_time * static_cast<double>(cycles));
+    }
+}
+
+// For the ISS modes, once simulated time has caught up with the core: the
+// WFI completes when irq is high, without time passing if it already is
+void SimpleCPU::wait_for_interrupt() {
+    if (!irq.read()) {
+        sc_time start = sc_time_stamp();
+        wait(irq.posedge_event());
+        ++SimStats::process_activations;
+        profiler.count_wait(static_cast<uint64_t>((sc_time_stamp() - start) / cycle_time));
+    }
+    core.complete_wait();
+}
+
+void SimpleCPU::set_quantum(unsigned instructions) {
+    quantum_instructions = instructions > 0 ? instructions : 1;
+    tlm_utils::tlm_quantumkeeper::set_global_quantum(cycle_time * static_cast<double>(quantum_instructions));
+}
+
+void SimpleCPU::run_decoupled() {
+    ++SimStats::process_activations;
+    load_core_state();
+    core.bus = &transport_bus;
+    acquire_dmi();
+
+    qk.reset();
+    accounted_instructions = core.instructions_executed;
+    FunctionalCore::StopReason reason = FunctionalCore::RUNNING;
+    while (reason == FunctionalCore::RUNNING && core.instructions_executed < instruction_limit) {
+        // Run ahead of simulated time for the rest of the quantum
+        uint64_t used = static_cast<uint64_t>(qk.get_local_time() / cycle_time);
+        uint64_t budget = used < quantum_instructions ? quantum_instructions - used : 1;
+        budget = std::min(budget, instruction_limit - core.instructions_executed);
+        reason = core.run(budget);
+        account_core_time();
+        if (reason == FunctionalCore::WAITING_FOR_INTERRUPT) {
+            qk.sync();
+            wait_for_interrupt();
+            reason = FunctionalCore::RUNNING;
+        } else if (qk.need_sync()) {
+            qk.sync();
+            ++SimStats::process_activations;
+        }
+    }
+    qk.sync();
+    store_core_state();
+    finish_core(reason);
+}
+
+void SimpleCPU::account_core_time() {
+    uint64_t cycles = core.instructions_executed - accounted_instructions + dcache_stall_cycles +
+                      core.branch_stall_cycles;
+    if (cycles > 0) {
+        qk.inc(cycle_time * static_cast<double>(cycles));
+        accounted_instructions = core.instructions_executed;
+        dcache_stall_cycles = 0;
+        core.branch_stall_cycles = 0;
+    }
+}
+
+void SimpleCPU::acquire_dmi() {
+    if (dcache) {
+        return; // Accesses through DMI would bypass the cache
+    }
+    tlm::tlm_generic_payload trans;
+    tlm::tlm_dmi dmi;
+    trans.set_command(tlm::TLM_READ_COMMAND);
+    trans.set_address(0);
+    if (data_socket->get_direct_mem_ptr(trans, dmi) && dmi.is_read_write_allowed() && dmi.get_start_address() == 0) {
+        core.attach_data(reinterpret_cast<uint16_t*>(dmi.get_dmi_ptr()),
+                         (dmi.get_end_address() + 1) / sizeof(uint16_t));
+    } else {
+        core.attach_data(nullptr, 0);
+    }
+}
+
+void SimpleCPU::invalidate_direct_mem_ptr(sc_dt::uint64, sc_dt::uint64) {
+    // Fall back to b_transport until the target offers DMI again
+    core.attach_data(nullptr, 0);
+}
+
+void SimpleCPU::transport(tlm::tlm_command cmd, unsigned addr, uint16_t& value) {
+    // A device has to see the access at the right simulated time, so catch
+    // up before issuing it. Plain memory (everything, with a data cache)
+    // gets the core's local time as the annotated delay and stays decoupled
+    // until the quantum is used up.
+    account_core_time();
+    if (dmem.device_at(addr)) {
+        qk.sync();
+    }
+
+    tlm::tlm_generic_payload trans;
+    sc_time delay = qk.get_local_time();
+    trans.set_command(cmd);
+    trans.set_address(static_cast<sc_dt::uint64>(addr) * sizeof(uint16_t));
+    trans.set_data_ptr(reinterpret_cast<unsigned char*>(&value));
+    trans.set_data_length(sizeof(uint16_t));
+    trans.set_streaming_width(sizeof(uint16_t));
+    trans.set_byte_enable_ptr(nullptr);
+    trans.set_dmi_allowed(false);
+    trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+    data_socket->b_transport(trans, delay);
+    if (trans.is_response_error()) {
+        SC_REPORT_ERROR("SimpleCPU", trans.get_response_string().c_str());
+    }
+    qk.set(delay);
+    if (qk.need_sync()) {
+        qk.sync();
+        ++SimStats::process_activations;
+    }
+
+    if (trans.is_dmi_allowed() && core.data_words == 0) {
+        acquire_dmi();
+    }
+}
+
+uint16_t SimpleCPU::TransportBus::read(unsigned addr) {
+    cpu.access_dcache(addr, false);
+    uint16_t value = 0;
+    cpu.transport(tlm::TLM_READ_COMMAND, addr, value);
+    return value;
+}
+
+void SimpleCPU::TransportBus::write(unsigned addr, uint16_t value) {
+    cpu.access_dcache(addr, true);
+    cpu.transport(tlm::TLM_WRITE_COMMAND, addr, value);
+}
+
+uint16_t SimpleCPU::MemoryBus::read(unsigned addr) {
+    if (addr >= cpu.dmem.memory.size()) {
+        SC_REPORT_ERROR("SimpleCPU", "Data address out of bounds!");
+        return 0;
+    }
+    cpu.access_dcache(addr, false);
+    if (cpu.dmem.device_at(addr) && sc_is_running()) {
+        cpu.sync_core_time(); // The device sees the access at its simulated time
+    }
+    return cpu.dmem.read_untraced(addr);
+}
+
+void SimpleCPU::MemoryBus::write(unsigned addr, uint16_t value) {
+    if (addr >= cpu.dmem.memory.size()) {
+        SC_REPORT_ERROR("SimpleCPU", "Data address out of bounds!");
+        return;
+    }
+    cpu.access_dcache(addr, true);
+    if (cpu.dmem.device_at(addr) && sc_is_running()) {
+        cpu.sync_core_time();
+    }
+    cpu.dmem.write_untraced(addr, value);
+}
+
+void SimpleCPU::enable_data_cache(const CacheConfig& config) {
+    dcache.reset(new Cache(config));
+    pipeline.dcache = dcache.get();
+}
+
+void SimpleCPU::set_branch_predictor(std::unique_ptr<BranchPredictor> predictor) {
+    branch_predictor = std::move(predictor);
+    pipeline.predictor = branch_predictor.get();
+    core.predictor = branch_predictor.get();
+}
+
+void SimpleCPU::use_shared_memory(DataMemory& memory, SharedBus& bus, unsigned port) {
+    if (mode != PIPELINED) {
+        SC_REPORT_ERROR("SimpleCPU", "Shared data memory requires PIPELINED mode.");
+        return;
+    }
+    pipeline.use_shared_memory(memory, bus, port);
+    shared_bus = &bus;
+    bus_port = port;
+}
+
+void SimpleCPU::access_dcache(uint64_t addr, bool write) {
+    if (dcache) {
+        dcache_stall_cycles += dcache->access(addr & DATA_ADDR_MASK, write);
+    }
+}
+
+void SimpleCPU::set_instruction_limit(uint64_t instructions) {
+    instruction_limit = instructions;
+}
+
+uint64_t SimpleCPU::instructions_retired() const {
+    if (mode == PIPELINED) {
+        return pipeline.instructions;
+    }
+    return clocked() ? ctrl.instructions_decoded : core.instructions_executed;
+}
+
+unsigned SimpleCPU::next_pc() const {
+    if (mode != SIGNAL_LEVEL) {
+        return pc.pc.to_uint(); // Written back by store_core_state, evaluate_datapath or clock_pipeline
+    }
+    // The datapath executes the instruction at pc.pc in the cycle it is
+    // fetched, so unless that was a HALT the next one follows it
+    if (ctrl.instructions_decoded == 0) {
+        return pc.reset_address.to_uint();
+    }
+    if (decoded_instruction.read().opcode == HALT) {
+        return pc.pc.to_uint();
+    }
+    if (branch_taken_sig.read()) {
+        return branch_target_sig.read().to_uint();
+    }
+    return (pc.pc.to_uint() + 1) & ADDR_MASK;
+}
+
+Checkpoint SimpleCPU::checkpoint() const {
+    Checkpoint cp;
+    cp.program = imem.memory;
+    for (uint64_t index : dmem.memory.resident_pages()) {
+        const uint16_t* words = dmem.memory.page_for_read(index);
+        Checkpoint::Page page = { index, std::vector<uint16_t>(words, words + PagedMemory::PAGE_WORDS) };
+        cp.data_pages.push_back(std::move(page));
+    }
+    for (int i = 0; i < NUM_REGISTERS; ++i) {
+        cp.registers[i] = static_cast<uint16_t>(regfile.registers[i]);
+    }
+    cp.pc = next_pc();
+    cp.instructions = restored_instructions + instructions_retired();
+    cp.time = simulated_time();
+    return cp;
+}
+
+void SimpleCPU::restore(const Checkpoint& cp) {
+    imem.load_program(cp.program.data(), cp.program.size());
+    dmem.clear();
+    for (const Checkpoint::Page& page : cp.data_pages) {
+        dmem.load(page.words.data(), page.words.size(), page.index * PagedMemory::PAGE_WORDS);
+    }
+    for (int i = 0; i < NUM_REGISTERS; ++i) {
+        regfile.registers[i] = cp.registers[i];
+    }
+    pc.reset_address = cp.pc;
+    pc.pc = cp.pc;
+    restored_instructions = cp.instructions;
+    restored_time = cp.time;
+}
+
+FunctionalCore::StopReason SimpleCPU::fast_forward(uint64_t max_instructions, int stop_pc) {
+    if (stop_pc > static_cast<int>(ADDR_MASK)) {
+        SC_REPORT_ERROR("SimpleCPU", "Fast-forward stop PC is out of bounds!");
+        return FunctionalCore::PC_OUT_OF_BOUNDS;
+    }
+    load_core_state();
+    core.profiler = nullptr;
+    FunctionalCore::StopReason reason = stop_pc < 0 ? core.run(max_instructions)
+                                                    : core.run_until(static_cast<unsigned>(stop_pc), max_instructions);
+    core.profiler = &profiler;
+    store_core_state();
+    if (dcache) {
+        dcache->reset_counters(); // Keep the warmed-up lines
+        dcache_stall_cycles = 0;
+    }
+    if (branch_predictor) {
+        branch_predictor->reset_counters(); // Keep what it learned
+        core.branch_stall_cycles = 0;
+    }
+
+    pc.reset_address = core.pc;
+    restored_instructions += core.instructions_executed;
+    restored_time += cycle_time * static_cast<double>(core.instructions_executed);
+
+    std::ostringstream msg;
+    msg << "Fast-forwarded " << core.instructions_executed << " instructions to PC " << core.pc;
+    SC_REPORT_INFO("SimpleCPU", msg.str().c_str());
+    if (reason == FunctionalCore::HALTED) {
+        SC_REPORT_WARNING("SimpleCPU", "Program halted during fast-forward.");
+    } else if (reason == FunctionalCore::PC_OUT_OF_BOUNDS) {
+        SC_REPORT_WARNING("SimpleCPU", "PC left the program during fast-forward.");
+    } else if (reason == FunctionalCore::WAITING_FOR_INTERRUPT) {
+        SC_REPORT_WARNING("SimpleCPU", "Fast-forward stopped at a WFI, which the simulation executes again.");
+    }
+    return reason;
+}
+
+sc_time SimpleCPU::simulated_time() const {
+    return restored_time + sc_time_stamp();
+}
+
+void SimpleCPU::dump_profile_at_stop(std::ostream& os) {
+    profile_stream = &os;
+}
+
+void SimpleCPU::end_of_simulation() {
+    if (profile_stream) {
+        profiler.dump(*profile_stream);
+        if (mode == PIPELINED) {
+            pipeline.dump(*profile_stream);
+        }
+        if (dcache) {
+            dcache->dump(*profile_stream);
+        }
+        if (branch_predictor) {
+            branch_predictor->dump(*profile_stream);
+        }
+        // Kernel cost of the run, to compare the modes
+        uint64_t retired = instructions_retired();
+        *profile_stream << "Delta cycles: " << sc_delta_count()
+                        << ", process activations: " << SimStats::process_activations;
+        if (retired > 0) {
+            *profile_stream << " (" << static_cast<double>(sc_delta_count()) / retired << " and "
+                            << static_cast<double>(SimStats::process_activations) / retired
+                            << " per instruction)";
+        }
+        *profile_stream << std::endl;
+    }
+}
+
+void SimpleCPU::load_instruction_memory(const std::vector<word>& program) {
+    imem.load_program(program);
+}
+
+void SimpleCPU::load_image(const ProgramImage& image) {
+    load_image(image, false);
+}
+
+void SimpleCPU::map_image(const ProgramImage& image) {
+    load_image(image, true);
+}
+
+void SimpleCPU::load_image(const ProgramImage& image, bool map_data) {
+    for (const ProgramImage::Segment& seg : image.segments()) {
+        if (seg.kind == ProgramImage::PROGRAM) {
+            if (seg.load_address != 0) {
+                SC_REPORT_ERROR("SimpleCPU", "Program segments must be loaded at address 0.");
+            }
+            imem.load_program(seg.words, seg.word_count);
+        } else if (map_data) {
+            dmem.map(seg.words, seg.word_count, seg.load_address);
+        } else {
+            dmem.load(seg.words, seg.word_count, seg.load_address);
+        }
+    }
+}
+
+void SimpleCPU::load_data_memory(const std::vector<word>& data) {
+    for (size_t i = 0; i < data.size() && i < dmem.memory.size(); ++i) {
+        dmem.memory.write(i, data[i].to_uint());
+    }
+}
@@ -0,0 +1,218 @@
+#ifndef SIMPLE_CPU_H
+#define SIMPLE_CPU_H
+
+#include <systemc.h>
+#include <tlm.h>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <tlm_utils/tlm_quantumkeeper.h>
+#include <memory>
+#include <vector>
+#include "instruction_memory.h"
+#include "data_memory.h"
+#include "program_counter.h"
+#include "control_unit.h"
+#include "register_file.h"
+#include "alu.h"
+#include "functional_core.h"
+#include "pipeline.h"
+#include "cache.h"
+#include "branch_predictor.h"
+#include "shared_bus.h"
+#include "profiler.h"
+#include "program_image.h"
+#include "checkpoint.h"
+#include "common.h"
+
+// How SimpleCPU executes the program, chosen at construction time
+enum ExecutionMode {
+    SIGNAL_LEVEL,   // Clocked datapath built from sc_signals (default)
+    FUNCTIONAL_ISS, // Instruction-set simulator running in a single SC_THREAD
+    DECOUPLED_ISS,  // ISS running ahead of simulated time, one quantum at a time
+    LEVELIZED,      // The datapath modules' logic evaluated in a fixed order, once per clock edge
+    PIPELINED       // The same logic split into five pipeline stages (see pipeline.h)
+};
+
+SC_MODULE(SimpleCPU) {
+    InstructionMemory imem;
+    DataMemory dmem;
+    ProgramCounter pc;
+    ControlUnit ctrl;
+    RegisterFile regfile;
+    ALU alu;
+
+    // Only SIGNAL_LEVEL, LEVELIZED and PIPELINED are clocked. In the other
+    // modes no clock events are generated. Except in SIGNAL_LEVEL the PC is
+    // bound to clk_idle, so the datapath processes never run.
+    std::unique_ptr<sc_clock> clk;
+    sc_signal<bool> clk_idle;
+    sc_buffer<address> pc_addr; // Every write fetches, even of the same address
+    sc_signal<word> instruction;
+    sc_buffer<DecodedInstruction> decoded_instruction; // Every fetch decodes, even a jump to itself
+    sc_signal<bool> pc_en;
+    sc_signal<bool> mem_rd, mem_wr;
+    sc_signal<address> mem_addr_sig;
+    sc_signal<word> mem_wr_data_sig, mem_rd_data_sig;
+    sc_signal<sc_uint<8>> rf_rd1_addr, rf_rd2_addr, rf_wr_addr;
+    sc_signal<word> rf_rd1_data, rf_rd2_data, rf_wr_data_sig;
+    sc_signal<bool> rf_wr_en;
+    sc_signal<word> alu_op1, alu_op2, alu_res;
+    sc_signal<sc_uint<8>> alu_ctrl_sig;
+    sc_signal<bool> reset_sig; // For PC reset
+    sc_signal<bool> wfi_sig;
+    sc_signal<bool> branch_taken_sig;
+    sc_signal<address> branch_target_sig;
+    // Interrupt line, level sensitive: a WFI waits while it is low. Bind a
+    // single device's output to it, e.g. Timer::irq.
+    sc_signal<bool> irq;
+
+    // Data memory as seen by the DECOUPLED_ISS core: DMI where the target
+    // grants it, b_transport otherwise.
+    tlm_utils::simple_initiator_socket<SimpleCPU> data_socket;
+
+    const ExecutionMode mode;
+    const sc_time cycle_time;
+    FunctionalCore core;
+    Pipeline pipeline; // Used in PIPELINED mode
+    Profiler profiler;
+    std::unique_ptr<Cache> dcache; // Optional, see enable_data_cache
+    std::unique_ptr<BranchPredictor> branch_predictor; // Optional, see set_branch_predictor
+
+    SC_HAS_PROCESS(SimpleCPU);
+    SimpleCPU(sc_module_name name, ExecutionMode mode = SIGNAL_LEVEL);
+
+    void connect_data_paths();
+    void reset_pc();
+    void run_iss();
+    void run_decoupled();
+    void evaluate_datapath();
+    void clock_pipeline();
+
+    // Whether the mode runs one instruction per clock period, so that
+    // sc_start bounds it rather than set_instruction_limit. PIPELINED has a
+    // clock but not a fixed CPI, so it is bounded like the ISS modes.
+    bool clocked() const { return mode == SIGNAL_LEVEL || mode == LEVELIZED; }
+
+    // Number of instructions the DECOUPLED_ISS core may run ahead of
+    // simulated time before it synchronizes (default 1000). Sets the global
+    // TLM quantum, so call it before sc_start.
+    void set_quantum(unsigned instructions);
+
+    // Put a data cache model in front of dmem, before sc_start. Every LOAD
+    // and STORE is looked up in it, in every mode. Misses stall PIPELINED
+    // and add to the simulated time of the ISS modes (for DECOUPLED_ISS as
+    // b_transport delay, since DMI is then not used); SIGNAL_LEVEL and
+    // LEVELIZED keep one instruction per cycle and only count. Accesses
+    // made by fast_forward warm the cache without being counted.
+    void enable_data_cache(const CacheConfig& config);
+
+    // Predict conditional branches with predictor (see branch_predictor.h),
+    // before sc_start. PIPELINED follows its predictions and pays for
+    // mispredictions with squashed instructions; the ISS modes add
+    // core.branch_penalty cycles per misprediction to simulated time.
+    // SIGNAL_LEVEL and LEVELIZED resolve each branch in the cycle it is
+    // fetched and do not use it. fast_forward trains it without counting.
+    void set_branch_predictor(std::unique_ptr<BranchPredictor> predictor);
+
+    // PIPELINED only: do data accesses in a DataMemory shared with other
+    // cores, through port of bus (see MultiCoreSystem), before sc_start.
+    // dmem is then unused. A drained pipeline tells the bus instead of
+    // stopping the simulation.
+    void use_shared_memory(DataMemory& memory, SharedBus& bus, unsigned port);
+
+    // Stop the ISS modes after this many instructions even without a HALT.
+    // PIPELINED stops fetching after this many and drains. The clocked
+    // modes are bounded by the sc_start duration instead.
+    void set_instruction_limit(uint64_t instructions);
+    // Instructions retired by this simulation, not counting a restored
+    // checkpoint
+    uint64_t instructions_retired() const;
+
+    // Capture the state after sc_start has returned. Instruction count and
+    // time include those of a restored checkpoint. In PIPELINED mode the
+    // state is only exact once the pipeline has drained, i.e. after a HALT
+    // or the instruction limit.
+    Checkpoint checkpoint() const;
+    // Load a checkpoint into a freshly elaborated CPU, before sc_start. This
+    // replaces the program and data memory; execution starts at its PC. The
+    // kernel's time still starts at zero, simulated_time() adds the
+    // checkpoint's.
+    void restore(const Checkpoint& checkpoint);
+    sc_time simulated_time() const;
+
+    // Sampling: before sc_start, execute up to max_instructions (or until
+    // the PC reaches stop_pc, if given) on FunctionalCore, without the
+    // kernel, and leave the resulting state in the datapath modules, so the
+    // simulation continues from there in the configured mode. The skipped
+    // instructions count as one clock period each in simulated_time() and
+    // are not profiled. Returns why the fast-forward stopped; RUNNING if it
+    // reached its limit or stop_pc.
+    FunctionalCore::StopReason fast_forward(uint64_t max_instructions, int stop_pc = -1);
+
+    // Print the profile when the simulation stops (see end_of_simulation).
+    // profiler.dump can also be called at any time.
+    void dump_profile_at_stop(std::ostream& os);
+    void end_of_simulation() override;
+
+    void load_instruction_memory(const std::vector<word>& program);
+    void load_data_memory(const std::vector<word>& data);
+    // Load every segment of image with bulk copies
+    void load_image(const ProgramImage& image);
+    // Like load_image, but data memory uses the whole pages of data
+    // segments in place (see DataMemory::map), so image must stay open for
+    // as long as the CPU is used.
+    void map_image(const ProgramImage& image);
+
+private:
+    // Routes the core's accesses outside the DMI window through data_socket
+    struct TransportBus : DataBus {
+        SimpleCPU& cpu;
+        explicit TransportBus(SimpleCPU& cpu) : cpu(cpu) {}
+        uint16_t read(unsigned addr) override;
+        void write(unsigned addr, uint16_t value) override;
+    };
+
+    // Reaches the rest of dmem.memory directly in FUNCTIONAL_ISS mode, or
+    // all of it through dcache
+    struct MemoryBus : DataBus {
+        SimpleCPU& cpu;
+        explicit MemoryBus(SimpleCPU& cpu) : cpu(cpu) {}
+        uint16_t read(unsigned addr) override;
+        void write(unsigned addr, uint16_t value) override;
+    };
+
+    TransportBus transport_bus;
+    MemoryBus memory_bus;
+    uint64_t instruction_limit;
+    tlm_utils::tlm_quantumkeeper qk;
+    unsigned quantum_instructions;
+    uint64_t accounted_instructions; // Instructions already added to qk
+    std::ostream* profile_stream;
+    uint64_t restored_instructions;
+    sc_time restored_time;
+    uint64_t dcache_stall_cycles; // Not yet added to the ISS modes' time
+    SharedBus* shared_bus;
+    unsigned bus_port;
+    bool pipeline_drained;
+
+    // LEVELIZED and PIPELINED: sleeping on irq instead of the clock
+    bool wfi_pending;           // LEVELIZED: the last instruction was a WFI
+    bool waiting_for_interrupt;
+    sc_time wait_start;
+
+    void access_dcache(uint64_t addr, bool write);
+    bool sleep_until_interrupt(bool waiting);
+    void wait_for_interrupt();
+
+    void load_image(const ProgramImage& image, bool map_data);
+    unsigned next_pc() const;
+    void load_core_state();
+    void store_core_state();
+    void finish_core(FunctionalCore::StopReason reason);
+    void account_core_time();
+    void sync_core_time();
+    void acquire_dmi();
+    void invalidate_direct_mem_ptr(sc_dt::uint64 start, sc_dt::uint64 end);
+    void transport(tlm::tlm_command cmd, unsigned addr, uint16_t& value);
+};
+
+#endif // SIMPLE_CPU_H
@@ -0,0 +1,115 @@
+#include "trace_log.h"
+#include "trace_stream.h"
+#include <memory>
+#include <string>
+
+TraceLevel TraceLog::levels[TRACE_MODULE_COUNT] = { TRACE_OFF, TRACE_OFF, TRACE_OFF };
+TraceBackend TraceLog::backend = TRACE_REPORT;
+std::vector<TraceRecord> TraceLog::ring;
+size_t TraceLog::ring_next = 0;
+size_t TraceLog::ring_count = 0;
+TraceStream* TraceLog::stream = nullptr;
+
+static const char* module_name(unsigned module) {
+    switch (module) {
+        case TRACE_REGISTER_FILE: return "RegisterFile";
+        case TRACE_DATA_MEMORY:   return "DataMemory";
+        case TRACE_FETCH:         return "InstructionMemory";
+        default:                  return "Unknown";
+    }
+}
+
+static std::string format_access(const TraceRecord& rec) {
+    if (rec.module == TRACE_FETCH) {
+        return "Fetched " + std::to_string(rec.value) + " from address " + std::to_string(rec.addr);
+    }
+    const char* target = rec.module == TRACE_REGISTER_FILE ? " register " : " address ";
+    if (rec.write) {
+        return "Wrote " + std::to_string(rec.value) + " to" + target + std::to_string(rec.addr);
+    }
+    return "Read " + std::to_string(rec.value) + " from" + target + std::to_string(rec.addr);
+}
+
+void TraceLog::set_level(TraceModule module, TraceLevel level) {
+    levels[module] = level;
+}
+
+void TraceLog::set_all_levels(TraceLevel level) {
+    for (int i = 0; i < TRACE_MODULE_COUNT; ++i) {
+        levels[i] = level;
+    }
+}
+
+void TraceLog::set_backend(TraceBackend new_backend, size_t ring_capacity) {
+    if (new_backend == TRACE_STREAM && stream == nullptr) {
+        // record() would have nowhere to write
+        SC_REPORT_WARNING("TraceLog", "TRACE_STREAM needs open_stream(); using TRACE_REPORT.");
+        new_backend = TRACE_REPORT;
+    }
+    if (backend == TRACE_STREAM && new_backend != TRACE_STREAM) {
+        close_stream();
+    }
+    backend = new_backend;
+    ring.assign(new_backend == TRACE_RING ? ring_capacity : 0, TraceRecord());
+    clear();
+}
+
+void TraceLog::record(TraceModule module, bool write, unsigned addr, unsigned value) {
+    TraceRecord rec;
+    rec.time = sc_time_stamp().value();
+    rec.addr = addr;
+    rec.value = static_cast<uint16_t>(value);
+    rec.module = static_cast<uint8_t>(module);
+    rec.write = write ? 1 : 0;
+
+    if (backend == TRACE_STREAM) {
+        stream->append(rec);
+        return;
+    }
+    if (backend == TRACE_REPORT || ring.empty()) {
+        SC_REPORT_INFO(module_name(module), format_access(rec).c_str());
+        return;
+    }
+    ring[ring_next] = rec;
+    ring_next = (ring_next + 1) % ring.size();
+    if (ring_count < ring.size()) {
+        ++ring_count;
+    }
+}
+
+bool TraceLog::open_stream(const std::string& path) {
+    close_stream();
+    std::unique_ptr<TraceStream> opened(new TraceStream());
+    if (!opened->open(path)) {
+        return false;
+    }
+    stream = opened.release();
+    set_backend(TRACE_STREAM);
+    return true;
+}
+
+void TraceLog::close_stream() {
+    if (stream != nullptr) {
+        stream->close();
+        delete stream;
+        stream = nullptr;
+    }
+    if (backend == TRACE_STREAM) {
+        backend = TRACE_REPORT;
+    }
+}
+
+void TraceLog::dump(std::ostream& os) {
+    // Oldest record first
+    size_t first = (ring_next + ring.size() - ring_count) % (ring.empty() ? 1 : ring.size());
+    for (size_t i = 0; i < ring_count; ++i) {
+        const TraceRecord& rec = ring[(first + i) % ring.size()];
+        os << sc_get_time_resolution() * static_cast<double>(rec.time) << " " << module_name(rec.module) << ": "
+           << format_access(rec) << std::endl;
+    }
+}
+
+void TraceLog::clear() {
+    ring_next = 0;
+    ring_count = 0;
+}
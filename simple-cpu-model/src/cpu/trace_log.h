@@ -0,0 +1,83 @@
+#ifndef TRACE_LOG_H
+#define TRACE_LOG_H
+
+#include <systemc.h>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Structured trace of the accesses made by the CPU modules. Each module has
+// its own level, checked by TRACE_ACCESS before any argument is evaluated,
+// so a disabled trace costs one load and compare. Enabled records either go
+// straight to SC_REPORT_INFO, or into a binary ring buffer that is only
+// formatted by dump(), or streamed to a compressed file (see trace_stream.h).
+
+enum TraceModule {
+    TRACE_REGISTER_FILE,
+    TRACE_DATA_MEMORY,
+    TRACE_FETCH,        // Instruction fetches: addr is the PC, value the instruction
+    TRACE_MODULE_COUNT
+};
+
+enum TraceLevel {
+    TRACE_OFF = 0,
+    TRACE_WRITES = 1,
+    TRACE_ACCESSES = 2  // Reads as well
+};
+
+enum TraceBackend {
+    TRACE_REPORT,  // Format every record and pass it to SC_REPORT_INFO
+    TRACE_RING,    // Keep the most recent records, format on dump()
+    TRACE_STREAM   // Write every record to a file, see open_stream()
+};
+
+class TraceStream;
+
+struct TraceRecord {
+    uint64_t time;    // sc_time_stamp().value(), in time resolution units
+    uint32_t addr;
+    uint16_t value;
+    uint8_t module;   // TraceModule
+    uint8_t write;    // 1 for writes, 0 for reads
+};
+
+class TraceLog {
+public:
+    static bool enabled(TraceModule module, TraceLevel level) {
+        return levels[module] >= level;
+    }
+
+    static void set_level(TraceModule module, TraceLevel level);
+    static void set_all_levels(TraceLevel level);
+    // TRACE_STREAM is only selected through open_stream(); without an open
+    // stream it falls back to TRACE_REPORT with a warning.
+    static void set_backend(TraceBackend backend, size_t ring_capacity = 1 << 16);
+    // Switch to TRACE_STREAM, writing to path from a background thread.
+    // Returns false, leaving the backend as it was, if path can't be
+    // created. close_stream() writes the rest; call it once the simulation
+    // is over.
+    static bool open_stream(const std::string& path);
+    static void close_stream();
+
+    static void record(TraceModule module, bool write, unsigned addr, unsigned value);
+    static void dump(std::ostream& os);
+    static void clear();
+
+private:
+    static TraceLevel levels[TRACE_MODULE_COUNT];
+    static TraceBackend backend;
+    static std::vector<TraceRecord> ring;
+    static size_t ring_next;   // Slot the next record goes into
+    static size_t ring_count;  // Valid records, up to ring.size()
+    static TraceStream* stream;
+};
+
+#define TRACE_ACCESS(module, level, write, addr, value)                  \
+    do {                                                                 \
+        if (TraceLog::enabled(module, level)) {                          \
+            TraceLog::record(module, write, addr, value);                \
+        }                                                                \
+    } while (0)
+
+#endif // TRACE_LOG_H
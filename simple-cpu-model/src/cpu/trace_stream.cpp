@@ -0,0 +1,240 @@
+#include "trace_stream.h"
+#include "byte_order.h"
+#include "common.h"
+#include <cmath>
+#include <cstring>
+
+static const uint16_t VERSION = 1;
+static const size_t HEADER_BYTES = 20;
+
+static void write_varint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static bool read_varint(const std::vector<uint8_t>& in, size_t& pos, uint64_t& v) {
+    v = 0;
+    for (unsigned shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        uint8_t b = in[pos++];
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t zigzag(int32_t v) {
+    return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+    return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+}
+
+static void encode_block(const std::vector<TraceRecord>& records, std::vector<uint8_t>& out) {
+    uint64_t time = 0;
+    uint32_t addr[TRACE_MODULE_COUNT] = {};
+    for (const TraceRecord& rec : records) {
+        unsigned module = rec.module < TRACE_MODULE_COUNT ? rec.module : 0;
+        out.push_back(static_cast<uint8_t>(module | (rec.write << 4)));
+        write_varint(out, rec.time - time);
+        write_varint(out, zigzag(static_cast<int32_t>(rec.addr - addr[module])));
+        write_varint(out, rec.value);
+        time = rec.time;
+        addr[module] = rec.addr;
+    }
+}
+
+TraceStream::TraceStream(size_t count) : stopping(false), file(nullptr), appended(0), dropped(0) {
+    // One buffer is always current, the others circulate
+    for (size_t i = 0; i < count + 1; ++i) {
+        buffers.emplace_back(new Block());
+        buffers.back()->reserve(BLOCK_RECORDS);
+        free_blocks.push_back(buffers.back().get());
+    }
+    current = free_blocks.back();
+    free_blocks.pop_back();
+}
+
+TraceStream::~TraceStream() {
+    close();
+}
+
+bool TraceStream::open(const std::string& path) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        SC_REPORT_ERROR("TraceStream", ("Cannot create " + path).c_str());
+        return false;
+    }
+    std::vector<uint8_t> header;
+    header.insert(header.end(), { 'S', 'C', 'T', 'R' });
+    write_le16(header, VERSION);
+    write_le16(header, ADDR_SIZE);
+    write_le16(header, DATA_ADDR_SIZE);
+    write_le16(header, 0);
+    write_le64(header, static_cast<uint64_t>(std::llround(sc_get_time_resolution().to_seconds() * 1e15)));
+    std::fwrite(header.data(), 1, header.size(), file);
+
+    current->clear();
+    stopping = false;
+    appended = 0;
+    dropped = 0;
+    writer = std::thread(&TraceStream::write_blocks, this);
+    return true;
+}
+
+void TraceStream::submit() {
+    if (file == nullptr) {
+        current->clear();
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free_blocks.empty()) {
+        // The writer is behind; lose this block rather than wait for it
+        dropped += current->size();
+        current->clear();
+        return;
+    }
+    appended += current->size();
+    full_blocks.push_back(current);
+    current = free_blocks.back();
+    free_blocks.pop_back();
+    wake.notify_one();
+}
+
+void TraceStream::write_blocks() {
+    std::vector<uint8_t> out;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this]() { return stopping || !full_blocks.empty(); });
+        if (full_blocks.empty()) {
+            return; // Stopping, and everything is written
+        }
+        Block* block = full_blocks.front();
+        full_blocks.pop_front();
+        lock.unlock();
+
+        out.clear();
+        write_le32(out, static_cast<uint32_t>(block->size()));
+        write_le32(out, 0); // Length, filled in below
+        encode_block(*block, out);
+        uint32_t length = static_cast<uint32_t>(out.size() - 8);
+        for (int i = 0; i < 4; ++i) {
+            out[4 + i] = static_cast<uint8_t>(length >> (8 * i));
+        }
+        std::fwrite(out.data(), 1, out.size(), file);
+        block->clear();
+
+        lock.lock();
+        free_blocks.push_back(block);
+    }
+}
+
+void TraceStream::close() {
+    if (file == nullptr) {
+        return;
+    }
+    if (!current->empty()) {
+        // Queued even without a free buffer, so the end is never dropped
+        std::lock_guard<std::mutex> lock(mutex);
+        appended += current->size();
+        full_blocks.push_back(current);
+        current = nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+    if (current == nullptr) {
+        current = free_blocks.back();
+        free_blocks.pop_back();
+    }
+    std::fclose(file);
+    file = nullptr;
+    if (dropped > 0) {
+        std::string msg = std::to_string(dropped) + " of " + std::to_string(appended + dropped) +
+                          " trace records were dropped because the writer fell behind.";
+        SC_REPORT_WARNING("TraceStream", msg.c_str());
+    }
+}
+
+TraceReader::TraceReader() :
+    addr_size(0), data_addr_size(0), resolution_fs(0), file(nullptr), pos(0), left(0) {}
+
+TraceReader::~TraceReader() {
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+}
+
+bool TraceReader::open(const std::string& path) {
+    file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        SC_REPORT_ERROR("TraceReader", ("Cannot open " + path).c_str());
+        return false;
+    }
+    uint8_t header[HEADER_BYTES];
+    if (std::fread(header, 1, HEADER_BYTES, file) != HEADER_BYTES ||
+        std::memcmp(header, "SCTR", 4) != 0 || read_le16(header + 4) != VERSION) {
+        SC_REPORT_ERROR("TraceReader", ("Bad trace file " + path).c_str());
+        return false;
+    }
+    addr_size = read_le16(header + 6);
+    data_addr_size = read_le16(header + 8);
+    resolution_fs = read_le64(header + 12);
+    return true;
+}
+
+bool TraceReader::read_block() {
+    uint8_t head[8];
+    if (std::fread(head, 1, 8, file) != 8) {
+        return false;
+    }
+    left = read_le32(head);
+    block.resize(read_le32(head + 4));
+    if (std::fread(block.data(), 1, block.size(), file) != block.size()) {
+        return false;
+    }
+    pos = 0;
+    previous = TraceRecord();
+    std::memset(previous_addr, 0, sizeof(previous_addr));
+    return true;
+}
+
+bool TraceReader::next(TraceRecord& rec) {
+    if (file == nullptr) {
+        return false;
+    }
+    while (left == 0) {
+        if (!read_block()) {
+            return false;
+        }
+    }
+    if (pos >= block.size()) {
+        return false;
+    }
+    uint8_t tag = block[pos++];
+    uint64_t dt, addr_delta, value;
+    if (!read_varint(block, pos, dt) || !read_varint(block, pos, addr_delta) || !read_varint(block, pos, value)) {
+        return false;
+    }
+    rec.module = tag & 0x0F;
+    rec.write = (tag >> 4) & 1;
+    if (rec.module >= TRACE_MODULE_COUNT) {
+        return false;
+    }
+    rec.time = previous.time + dt;
+    rec.addr = previous_addr[rec.module] + static_cast<uint32_t>(unzigzag(static_cast<uint32_t>(addr_delta)));
+    rec.value = static_cast<uint16_t>(value);
+    previous = rec;
+    previous_addr[rec.module] = rec.addr;
+    --left;
+    return true;
+}
@@ -0,0 +1,98 @@
+#ifndef TRACE_STREAM_H
+#define TRACE_STREAM_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "trace_log.h"
+
+// Compact binary trace file for long runs, written by TraceLog's
+// TRACE_STREAM backend and read back by TraceReader (e.g. by the
+// simple_cpu_trace_to_vcd converter).
+//
+// The simulation thread only copies each record into the current block.
+// Full blocks are handed to a writer thread through a bounded set of block
+// buffers, and the writer compresses and writes them. If the writer falls
+// behind and no buffer is free, the block is dropped and counted instead of
+// waiting, so tracing never stalls the simulation.
+//
+// The file format is little-endian: "SCTR", uint16 version (1), uint16
+// ADDR_SIZE, uint16 DATA_ADDR_SIZE, uint16 reserved, uint64 time resolution
+// in femtoseconds, then blocks of uint32 record count, uint32 length in
+// bytes and the encoded records. Each record is a byte of module | write << 4
+// followed by varints of the time since the previous record, the zigzagged
+// difference to the previous address of the same module, and the value.
+// Every block starts from time 0 and addresses 0, so blocks decode
+// independently.
+class TraceStream {
+public:
+    static const size_t BLOCK_RECORDS = 4096;
+
+    explicit TraceStream(size_t buffers = 8);
+    ~TraceStream();
+
+    bool open(const std::string& path);
+    void append(const TraceRecord& rec) {
+        current->push_back(rec);
+        if (current->size() == BLOCK_RECORDS) {
+            submit();
+        }
+    }
+    // Write the last partial block, stop the writer and close the file.
+    // Reports a warning with the count if any records were dropped.
+    void close();
+
+    uint64_t records() const { return appended; }  // Queued for writing
+    uint64_t dropped_records() const { return dropped; }
+
+private:
+    typedef std::vector<TraceRecord> Block;
+
+    std::vector<std::unique_ptr<Block>> buffers;
+    Block* current;
+    std::vector<Block*> free_blocks;
+    std::deque<Block*> full_blocks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread writer;
+    bool stopping;
+    FILE* file;
+    uint64_t appended;
+    uint64_t dropped;
+
+    void submit();
+    void write_blocks();
+};
+
+// Sequential reader for files written by TraceStream
+class TraceReader {
+public:
+    unsigned addr_size;
+    unsigned data_addr_size;
+    uint64_t resolution_fs;
+
+    TraceReader();
+    ~TraceReader();
+
+    bool open(const std::string& path);
+    // False at the end of the file or on a corrupt block
+    bool next(TraceRecord& rec);
+
+private:
+    FILE* file;
+    std::vector<uint8_t> block;
+    size_t pos;
+    uint32_t left; // Records left in block
+    TraceRecord previous;
+    uint32_t previous_addr[TRACE_MODULE_COUNT];
+
+    bool read_block();
+};
+
+#endif // TRACE_STREAM_H
@@ -1,167 +1,281 @@
 #include <systemc.h>
-#include "cpu/instruction_memory.h"
-#include "cpu/data_memory.h"
-#include "cpu/program_counter.h"
-#include "cpu/control_unit.h"
-#include "cpu/register_file.h"
-#include "cpu/alu.h"
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <iostream>
+#include "cpu/simple_cpu.h"
+#include "cpu/trace_log.h"
+#include "cpu/program_image.h"
+#include "cpu/mmio.h"
 #include "cpu/common.h"
 
 
 
-SC_MODULE(SimpleCPU) {
-    InstructionMemory imem;
-    DataMemory dmem;
-    ProgramCounter pc;
-    ControlUnit ctrl;
-    RegisterFile regfile;
-    ALU alu;
-
-    sc_clock clk;
-    sc_signal<address> pc_addr;
-    sc_signal<word> instruction;
-    sc_signal<bool> pc_en;
-    sc_signal<bool> mem_rd, mem_wr;
-    sc_signal<address> mem_addr_sig;
-    sc_signal<word> mem_wr_data_sig, mem_rd_data_sig;
-    sc_signal<sc_uint<8>> rf_rd1_addr, rf_rd2_addr, rf_wr_addr;
-    sc_signal<word> rf_rd1_data, rf_rd2_data, rf_wr_data_sig;
-    sc_signal<bool> rf_wr_en;
-    sc_signal<word> alu_op1, alu_op2, alu_res;
-    sc_signal<sc_uint<8>> alu_ctrl_sig;
-    sc_signal<bool> reset_sig; // For PC reset
-
-    SC_CTOR(SimpleCPU) :
-        imem("imem"),
-        dmem("dmem"),
-        pc("pc"),
-        ctrl("ctrl"),
-        regfile("regfile"),
-        alu("alu"),
-        clk("clock", 10, SC_NS),
-        reset_sig("reset", true) // Initialize reset high
-    {
-        // Instruction Memory Connections
-        imem.addr_in(pc_addr);
-        imem.instruction_out(instruction);
-
-        // Program Counter Connections
-        pc.clk(clk);
-        pc.reset(reset_sig);
-        pc.enable(pc_en);
-        pc.current_address(pc_addr);
-
-        // Control Unit Connections
-        ctrl.instruction_in(instruction);
-        ctrl.pc_enable(pc_en);
-        ctrl.mem_read_enable(mem_rd);
-        ctrl.mem_write_enable(mem_wr);
-        ctrl.mem_addr(mem_addr_sig);
-        ctrl.mem_write_data(mem_wr_data_sig);
-        ctrl.reg_read1_addr(rf_rd1_addr);
-        ctrl.reg_read2_addr(rf_rd2_addr);
-        ctrl.reg_write_addr(rf_wr_addr);
-        ctrl.reg_write_enable(rf_wr_en);
-        ctrl.alu_operand1(alu_op1);
-        ctrl.alu_operand2(alu_op2);
-        ctrl.alu_control(alu_ctrl_sig);
+int sc_main(int argc, char* argv[]) {
+    // Pass --iss to run the program on the instruction-set simulator
+    // instead of the signal-level datapath, or --decoupled [--quantum N] to
+    // let the simulator run N instructions ahead of simulated time.
+    // --levelized evaluates the datapath once per clock edge instead of
+    // through its signals. --pipelined runs the five-stage pipeline and
+    // prints its CPI, stalls and forwarding counts at the end.
+    // Register and memory writes are reported as they happen; --trace-ring
+    // buffers them instead and prints them at the end, --no-trace drops them.
+    // --trace-stream FILE writes them and every instruction fetch to a
+    // compressed trace file instead (see trace_stream.h), which
+    // simple_cpu_trace_to_vcd converts to VCD.
+    // --profile prints the execution profile when the simulation stops.
+    // --program FILE and --data FILE load images (see program_image.h)
+    // instead of the built-in example, and run until HALT.
+    // --instructions N stops after N instructions instead.
+    // --restore FILE starts from a checkpoint instead of reset, --save FILE
+    // writes one when the simulation stops (see checkpoint.h).
+    // --fast-forward N runs the first N instructions (or, with
+    // --fast-forward-to PC, those up to that PC) on the functional core and
+    // simulates only the rest in the chosen mode.
+    // --cache puts a data cache in front of data memory and prints its
+    // statistics at the end; --cache-size, --cache-line and --cache-ways
+    // (in words), --cache-fifo or --cache-random, --cache-write-through
+    // and --cache-stats-only change its configuration (see cache.h).
+    // --predictor not-taken|backward-taken|bimodal|gshare predicts branches
+    // in PIPELINED and the ISS modes and prints its accuracy at the end;
+    // --predictor-bits and --history-bits size the tables (see
+    // branch_predictor.h).
+    // --devices maps a Timer at 0x30 and a Console at 0x38 into data memory
+    // (see mmio.h) with the timer driving the interrupt line; without
+    // --program it runs a demo that sleeps on WFI until the timer expires
+    // and then prints "OK" to the console.
+    ExecutionMode mode = SIGNAL_LEVEL;
+    unsigned quantum = 0;
+    TraceLevel trace_level = TRACE_WRITES;
+    TraceBackend trace_backend = TRACE_REPORT;
+    const char* trace_path = nullptr;
+    bool profile = false;
+    const char* program_path = nullptr;
+    const char* data_path = nullptr;
+    const char* restore_path = nullptr;
+    const char* save_path = nullptr;
+    uint64_t instructions = 0;
+    uint64_t fast_forward = 0;
+    int fast_forward_pc = -1;
+    bool cache = false;
+    CacheConfig cache_config;
+    bool devices = false;
+    bool predictor = false;
+    BranchPredictorConfig predictor_config;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--restore") == 0 && i + 1 < argc) {
+            restore_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            save_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--fast-forward") == 0 && i + 1 < argc) {
+            fast_forward = std::strtoull(argv[++i], nullptr, 0);
+        } else if (std::strcmp(argv[i], "--fast-forward-to") == 0 && i + 1 < argc) {
+            fast_forward_pc = std::strtol(argv[++i], nullptr, 0);
+        } else if (std::strcmp(argv[i], "--instructions") == 0 && i + 1 < argc) {
+            instructions = std::strtoull(argv[++i], nullptr, 0);
+        } else if (std::strcmp(argv[i], "--program") == 0 && i + 1 < argc) {
+            program_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--data") == 0 && i + 1 < argc) {
+            data_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--predictor") == 0 && i + 1 < argc) {
+            predictor = true;
+            const char* kind = argv[++i];
+            if (std::strcmp(kind, "not-taken") == 0) {
+                predictor_config.kind = PREDICT_NOT_TAKEN;
+            } else if (std::strcmp(kind, "backward-taken") == 0) {
+                predictor_config.kind = PREDICT_BACKWARD_TAKEN;
+            } else if (std::strcmp(kind, "gshare") == 0) {
+                predictor_config.kind = PREDICT_GSHARE;
+            } else if (std::strcmp(kind, "bimodal") != 0) {
+                SC_REPORT_WARNING("main", "Unknown branch predictor; using bimodal.");
+            }
+        } else if (std::strcmp(argv[i], "--predictor-bits") == 0 && i + 1 < argc) {
+            predictor_config.table_bits = std::strtoul(argv[++i], nullptr, 0);
+        } else if (std::strcmp(argv[i], "--history-bits") == 0 && i + 1 < argc) {
+            predictor_config.history_bits = std::strtoul(argv[++i], nullptr, 0);
+        } else if (std::strcmp(argv[i], "--devices") == 0) {
+            devices = true;
+        } else if (std::strcmp(argv[i], "--profile") == 0) {
+            profile = true;
+        } else if (std::strcmp(argv[i], "--trace-ring") == 0) {
+            trace_backend = TRACE_RING;
+        } else if (std::strcmp(argv[i], "--trace-stream") == 0 && i + 1 < argc) {
+            trace_backend = TRACE_STREAM;
+            trace_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--no-trace") == 0) {
+            trace_level = TRACE_OFF;
+        } else if (std::strcmp(argv[i], "--iss") == 0) {
+            mode = FUNCTIONAL_ISS;
+        } else if (std::strcmp(argv[i], "--levelized") == 0) {
+            mode = LEVELIZED;
+        } else if (std::strcmp(argv[i], "--pipelined") == 0) {
+            mode = PIPELINED;
+        } else if (std::strcmp(argv[i], "--decoupled") == 0) {
+            mode = DECOUPLED_ISS;
+        } else if (std::strcmp(argv[i], "--quantum") == 0 && i + 1 < argc) {
+            quantum = std::strtoul(argv[++i], nullptr, 0);
+        } else if (std::strncmp(argv[i], "--cache", 7) == 0) {
+            cache = true;
+            if (std::strcmp(argv[i], "--cache-size") == 0 && i + 1 < argc) {
+                cache_config.size_words = std::strtoul(argv[++i], nullptr, 0);
+            } else if (std::strcmp(argv[i], "--cache-line") == 0 && i + 1 < argc) {
+                cache_config.line_words = std::strtoul(argv[++i], nullptr, 0);
+            } else if (std::strcmp(argv[i], "--cache-ways") == 0 && i + 1 < argc) {
+                cache_config.ways = std::strtoul(argv[++i], nullptr, 0);
+            } else if (std::strcmp(argv[i], "--cache-fifo") == 0) {
+                cache_config.replacement = CACHE_FIFO;
+            } else if (std::strcmp(argv[i], "--cache-random") == 0) {
+                cache_config.replacement = CACHE_RANDOM;
+            } else if (std::strcmp(argv[i], "--cache-write-through") == 0) {
+                cache_config.write_policy = CACHE_WRITE_THROUGH;
+            } else if (std::strcmp(argv[i], "--cache-stats-only") == 0) {
+                cache_config.timed = false;
+            }
+        }
+    }
 
-        // Register File Connections
-        regfile.read_reg1_addr(rf_rd1_addr);
-        regfile.read_reg2_addr(rf_rd2_addr);
-        regfile.write_reg_addr(rf_wr_addr);
-        regfile.write_data(rf_wr_data_sig);
-        regfile.write_enable(rf_wr_en);
-        regfile.read_data1(rf_rd1_data);
-        regfile.read_data2(rf_rd2_data);
+    TraceLog::set_all_levels(trace_level);
+    if (trace_backend == TRACE_STREAM) {
+        if (!TraceLog::open_stream(trace_path)) {
+            return 1; // Already reported
+        }
+        TraceLog::set_level(TRACE_FETCH, TRACE_ACCESSES);
+    } else {
+        TraceLog::set_backend(trace_backend);
+    }
 
-        // ALU Connections
-        alu.operand1(alu_op1);
-        alu.operand2(alu_op2);
-        alu.alu_control(alu_ctrl_sig);
-        alu.result(alu_res);
+    SimpleCPU cpu("cpu", mode);
+    if (quantum > 0) {
+        cpu.set_quantum(quantum);
+    }
+    if (profile) {
+        cpu.dump_profile_at_stop(std::cout);
+    }
+    if (cache) {
+        cpu.enable_data_cache(cache_config);
+    }
+    if (predictor) {
+        cpu.set_branch_predictor(make_branch_predictor(predictor_config));
+    }
+    std::unique_ptr<Timer> timer;
+    Console console(&std::cout);
+    if (devices) {
+        timer.reset(new Timer("timer", cpu.cycle_time));
+        timer->irq(cpu.irq);
+        cpu.dmem.map_device(0x30, *timer);
+        cpu.dmem.map_device(0x38, console);
+    }
 
-        // Data Memory Connections
-        dmem.addr_in(mem_addr_sig);
-        dmem.data_in(mem_wr_data_sig);
-        dmem.write_enable(mem_wr);
-        dmem.data_out(mem_rd_data_sig);
+    // Example Program:
+    // LOAD R1, 10   (Load value at address 10 into R1)
+    // LOAD R2, 11   (Load value at address 11 into R2)
+    // ADD R3, R1, R2 (Add R1 and R2, store result in R3)
+    // STORE R3, 12  (Store R3 to address 12)
+    // HALT
+    //
+    // Encoding: opcode[15:12] rd[11:9] rs1[8:6] immediate[5:0], rs2 = immediate[5:3]
+    std::vector<word> program = {
+        0x120A, // LOAD R1, 10
+        0x140B, // LOAD R2, 11
+        0x3650, // ADD R3, R1, R2
+        0x20CC, // STORE R3, 12
+        0x0000  // HALT
+    };
+    std::vector<word> data(13, 0);
+    data[10] = 0x000A; // Address 10
+    data[11] = 0x000B; // Address 11
+    data[12] = 0x0000; // Address 12 (for storing result)
 
-        // Connecting data paths based on instruction type
-        SC_METHOD(connect_data_paths);
-        sensitive << instruction << rf_rd1_data << rf_rd2_data << alu_res << mem_rd_data_sig;
-        dont_initialize();
+    // Device demo:
+    // LOAD R1, 20; STORE R1, 0x30  (Start the timer: 50 periods)
+    // WFI                          (Sleep until it expires)
+    // LOAD R2, 21; STORE R2, 0x32  (Acknowledge, which lowers irq)
+    // LOAD R3, 22..24; STORE R3, 0x38 for each (Print "OK\n")
+    // HALT
+    if (devices) {
+        program = {
+            0x1214, 0x2070, // LOAD R1, 20; STORE R1, 0x30
+            0x5000,         // WFI
+            0x1415, 0x20B2, // LOAD R2, 21; STORE R2, 0x32
+            0x1616, 0x20F8, // LOAD R3, 22; STORE R3, 0x38
+            0x1617, 0x20F8, // LOAD R3, 23; STORE R3, 0x38
+            0x1618, 0x20F8, // LOAD R3, 24; STORE R3, 0x38
+            0x0000          // HALT
+        };
+        data.resize(25, 0);
+        data[20] = 50;
+        data[21] = 1;
+        data[22] = 'O';
+        data[23] = 'K';
+        data[24] = '\n';
+    }
 
-        // Reset the PC after a short delay
-        SC_THREAD(reset_pc);
+    // Data segments are used in place, so the images stay open until exit
+    ProgramImage program_image, data_image;
+    Checkpoint restored;
+    bool run_to_halt = true;
+    if (restore_path) {
+        if (restored.load(restore_path)) {
+            cpu.restore(restored);
+        }
+    } else if (program_path || data_path) {
+        if (program_path && program_image.open(program_path, ProgramImage::PROGRAM)) {
+            cpu.map_image(program_image);
+        }
+        if (data_path && data_image.open(data_path, ProgramImage::DATA)) {
+            cpu.map_image(data_image);
+        }
+    } else {
+        cpu.load_instruction_memory(program);
+        cpu.load_data_memory(data);
+        run_to_halt = devices;
     }
 
-    void connect_data_paths() {
-        Opcode opcode = static_cast<Opcode>((instruction.read().range(15, 12)).to_uint());
+    if (fast_forward > 0 || fast_forward_pc >= 0) {
+        cpu.fast_forward(fast_forward > 0 ? fast_forward : UINT64_MAX, fast_forward_pc);
+    }
 
-        switch (opcode) {
-            case LOAD:
-                rf_wr_data_sig.write(mem_rd_data_sig);
-                break;
-            case STORE:
-                mem_wr_data_sig.write(rf_rd1_data); // Assuming we store the value of rs1
-                break;
-            case ADD:
-            case SUB:
-                alu_op1.write(rf_rd1_data);
-                alu_op2.write(rf_rd2_data);
-                rf_wr_data_sig.write(alu_res);
-                break;
-            case HALT:
-                break;
-            default:
-                break;
+    if (instructions > 0) {
+        cpu.set_instruction_limit(instructions);
+        if (cpu.clocked()) {
+            // Instruction k is fetched at (k + 1) clock periods
+            sc_start(cpu.cycle_time * (static_cast<double>(instructions) + 0.5));
+        } else {
+            sc_start();
         }
+    } else if (run_to_halt) {
+        sc_start(); // Run until HALT
+    } else {
+        sc_start(200, SC_NS); // Run the simulation for 200 ns, enough for the pipeline to drain
     }
 
-    void reset_pc() {
-        wait(5, SC_NS);
-        reset_sig.write(false);
+    if (save_path) {
+        cpu.checkpoint().save(save_path);
     }
 
-    void load_instruction_memory(const std::vector<word>& program) {
-        imem.load_program(program);
+    if (trace_backend == TRACE_RING) {
+        TraceLog::dump(std::cout);
+    } else if (trace_backend == TRACE_STREAM) {
+        TraceLog::close_stream();
     }
 
-    void load_data_memory(const std::vector<word>& data) {
-        for (size_t i = 0; i < data.size(); ++i) {
-            dmem.memory[i] = data[i];
+    if (!profile) { // Otherwise already part of the profile
+        if (mode == PIPELINED) {
+            cpu.pipeline.dump(std::cout);
+        }
+        if (cpu.dcache) {
+            cpu.dcache->dump(std::cout);
+        }
+        if (cpu.branch_predictor) {
+            cpu.branch_predictor->dump(std::cout);
         }
     }
-};
-
-
-
-int sc_main(int argc, char* argv[]) {
-    SimpleCPU cpu("cpu");
-
-    // Example Program:
-    // LOAD R1, 10   (Load value at address 10 into R1)
-    // LOAD R2, 11   (Load value at address 11 into R2)
-    // ADD R3, R1, R2 (Add R1 and R2, store result in R3)
-    // STORE R
-
-    // HALT
-    std::vector<word> program = {
-        0x000A0001, // LOAD R1, 10
-        0x000B0002, // LOAD R2, 11
-        0x000C0003, // ADD R3, R1, R2
-        0x000D0004, // STORE R3, 12
-        0x00000000  // HALT
-    };
-    std::vector<word> data = {
-        0x0000000A, // Address 10
-        0x0000000B, // Address 11
-        0x00000000, // Address 12 (for storing result)
-    };
-    cpu.load_instruction_memory(program);
-    cpu.load_data_memory(data);
-    sc_start(100, SC_NS); // Run the simulation for 100 ns
+    for (int i = 0; i < NUM_REGISTERS; ++i) {
+        std::cout << "R" << i << " = " << cpu.regfile.registers[i] << std::endl;
+    }
+    std::cout << "mem[12] = " << cpu.dmem.memory.read(12) << std::endl;
+    std::cout << "Data memory: " << cpu.dmem.memory.allocated_pages() << " pages allocated, "
+              << cpu.dmem.memory.mapped_pages() << " mapped, "
+              << cpu.dmem.memory.resident_bytes() << " bytes resident" << std::endl;
     return 0;
 }
-
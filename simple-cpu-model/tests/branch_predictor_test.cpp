@@ -0,0 +1,133 @@
+// The pipeline predicts a branch in IF while older ones are still on their
+// way to EX, and the ISS predicts each branch after the previous one has
+// resolved. A predictor must count the same branches and mispredictions in
+// both, including for branches fetched back to back, where gshare's history
+// and counters are only right if each prediction is carried to its branch.
+#include <systemc.h>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "branch_predictor.h"
+#include "data_memory.h"
+#include "decoder.h"
+#include "functional_core.h"
+#include "instruction_memory.h"
+#include "pipeline.h"
+#include "register_file.h"
+#include "workloads.h"
+
+static int failures = 0;
+
+struct Counts {
+    uint64_t instructions;
+    uint64_t branches;
+    uint64_t mispredictions;
+};
+
+static Counts run_iss(const std::vector<uint16_t>& program, const std::vector<uint16_t>& data,
+                      const BranchPredictorConfig& config, uint64_t instructions) {
+    std::unique_ptr<BranchPredictor> predictor = make_branch_predictor(config);
+    FunctionalCore core;
+    core.report_unknown_opcodes = false;
+    core.predictor = predictor.get();
+    core.load_program(program);
+    std::copy(data.begin(), data.end(), core.memory.begin());
+    core.run(instructions);
+    return { core.instructions_executed, predictor->branches, predictor->mispredictions };
+}
+
+// Drives the pipeline directly, one clock() per cycle, without the kernel
+static Counts run_pipeline(InstructionMemory& imem, RegisterFile& regfile, DataMemory& dmem,
+                           const std::vector<uint16_t>& program, const std::vector<uint16_t>& data,
+                           const BranchPredictorConfig& config, uint64_t instructions) {
+    std::unique_ptr<BranchPredictor> predictor = make_branch_predictor(config);
+    imem.load_program(std::vector<word>(program.begin(), program.end()));
+    dmem.clear();
+    dmem.load(data.data(), data.size());
+    for (int i = 0; i < NUM_REGISTERS; ++i) {
+        regfile.registers[i] = 0;
+    }
+    Pipeline pipeline(imem, regfile, dmem);
+    pipeline.predictor = predictor.get();
+    pipeline.reset(0, instructions);
+    while (pipeline.clock()) {
+    }
+    if (pipeline.branches != predictor->branches || pipeline.mispredictions != predictor->mispredictions) {
+        std::fprintf(stderr, "FAIL: pipeline and predictor counts differ\n");
+        ++failures;
+    }
+    return { pipeline.instructions, predictor->branches, predictor->mispredictions };
+}
+
+static void compare(const char* name, InstructionMemory& imem, RegisterFile& regfile, DataMemory& dmem,
+                    const std::vector<uint16_t>& program, const std::vector<uint16_t>& data, uint64_t instructions) {
+    const char* kinds[] = { "not taken", "backward taken", "bimodal", "gshare" };
+    for (int kind = PREDICT_NOT_TAKEN; kind <= PREDICT_GSHARE; ++kind) {
+        BranchPredictorConfig config;
+        config.kind = static_cast<BranchPredictorKind>(kind);
+        Counts iss = run_iss(program, data, config, instructions);
+        Counts pipelined = run_pipeline(imem, regfile, dmem, program, data, config, instructions);
+        if (iss.instructions != pipelined.instructions || iss.branches != pipelined.branches ||
+            iss.mispredictions != pipelined.mispredictions) {
+            std::fprintf(stderr,
+                         "FAIL: %s, %s: ISS %llu instructions, %llu branches, %llu mispredicted; "
+                         "pipeline %llu, %llu, %llu\n",
+                         name, kinds[kind], static_cast<unsigned long long>(iss.instructions),
+                         static_cast<unsigned long long>(iss.branches),
+                         static_cast<unsigned long long>(iss.mispredictions),
+                         static_cast<unsigned long long>(pipelined.instructions),
+                         static_cast<unsigned long long>(pipelined.branches),
+                         static_cast<unsigned long long>(pipelined.mispredictions));
+            ++failures;
+        }
+    }
+}
+
+int sc_main(int, char*[]) {
+    sc_report_handler::set_actions(SC_INFO, SC_DO_NOTHING);
+    InstructionMemory imem("imem");
+    RegisterFile regfile("regfile");
+    DataMemory dmem("dmem");
+
+    std::vector<uint16_t> data(64, 0);
+    data[0] = 1;
+    data[1] = 200;
+
+    // A branch that alternates, taken onto the loop branch right behind it
+    std::vector<uint16_t> toggle = {
+        encode_instruction(LOAD, 1, 0, 0), // R1 = 1
+        encode_instruction(LOAD, 2, 0, 1), // R2 = trip count
+        encode_alu(SUB, 3, 1, 3),          // R3 = 1 - R3: 1, 0, 1...
+        encode_alu(SUB, 2, 2, 1),
+        encode_branch(BEQZ, 3, 1),         // To the next instruction either way
+        encode_branch(BNEZ, 2, -3),
+        0                                  // HALT
+    };
+    compare("toggle", imem, regfile, dmem, toggle, data, 100000);
+
+    // Three adjacent branches with different periods
+    std::vector<uint16_t> adjacent = {
+        encode_instruction(LOAD, 1, 0, 0), // R1 = 1
+        encode_instruction(LOAD, 2, 0, 1), // R2 = trip count
+        encode_alu(SUB, 3, 1, 3),          // Period 2
+        encode_alu(ADD, 4, 4, 1),          // Counts up, wraps in 16 bits
+        encode_alu(SUB, 2, 2, 1),
+        encode_branch(BEQZ, 3, 1),
+        encode_branch(BNEZ, 4, 1),
+        encode_branch(BNEZ, 2, -5),
+        0                                  // HALT
+    };
+    compare("adjacent", imem, regfile, dmem, adjacent, data, 100000);
+
+    for (const Workload& workload : make_workloads()) {
+        compare(workload.name.c_str(), imem, regfile, dmem,
+                std::vector<uint16_t>(workload.program.begin(), workload.program.end()),
+                std::vector<uint16_t>(workload.data.begin(), workload.data.end()), 5000);
+    }
+
+    if (failures == 0) {
+        std::printf("branch_predictor_test: passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// Devices must see each access at the simulated time of its instruction,
+// however the core dispatches it. Runs the --devices demo of main.cpp in
+// both ISS modes, with and without superblocks, logging every device
+// access with its time; all four logs must be identical, and the timer
+// must be programmed by the second instruction, one clock period in.
+#include <systemc.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "fork_run.h"
+#include "mmio.h"
+#include "simple_cpu.h"
+
+// Forwards to device and appends every access to log
+class RecordingDevice : public MmioDevice {
+public:
+    RecordingDevice(MmioDevice& device, unsigned base, std::string& log) : device(device), base(base), log(log) {}
+
+    unsigned words() const override { return device.words(); }
+    uint16_t read(unsigned offset) override {
+        uint16_t value = device.read(offset);
+        record('R', offset, value);
+        return value;
+    }
+    void write(unsigned offset, uint16_t value) override {
+        record('W', offset, value);
+        device.write(offset, value);
+    }
+
+private:
+    MmioDevice& device;
+    unsigned base;
+    std::string& log;
+
+    void record(char kind, unsigned offset, uint16_t value) {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%c 0x%02x %u at %.1f ns\n", kind, base + offset, value,
+                      sc_time_stamp().to_seconds() * 1e9);
+        log += buf;
+    }
+};
+
+// Only ever called in a fresh child, see fork_run.h
+static std::string run_case(ExecutionMode mode, bool superblocks) {
+    sc_report_handler::set_actions(SC_INFO, SC_DO_NOTHING);
+
+    SimpleCPU cpu("cpu", mode);
+    cpu.core.use_superblocks = superblocks;
+    std::string log;
+    Timer timer("timer", cpu.cycle_time);
+    timer.irq(cpu.irq);
+    Console console;
+    RecordingDevice recorded_timer(timer, 0x30, log);
+    RecordingDevice recorded_console(console, 0x38, log);
+    cpu.dmem.map_device(0x30, recorded_timer);
+    cpu.dmem.map_device(0x38, recorded_console);
+
+    // Same program as simple_cpu_model --devices
+    std::vector<word> program = {
+        0x1214, 0x2070, // LOAD R1, 20; STORE R1, 0x30
+        0x5000,         // WFI
+        0x1415, 0x20B2, // LOAD R2, 21; STORE R2, 0x32
+        0x1616, 0x20F8, // LOAD R3, 22; STORE R3, 0x38
+        0x1617, 0x20F8, // LOAD R3, 23; STORE R3, 0x38
+        0x1618, 0x20F8, // LOAD R3, 24; STORE R3, 0x38
+        0x0000          // HALT
+    };
+    std::vector<word> data(25, 0);
+    data[20] = 50;
+    data[21] = 1;
+    data[22] = 'O';
+    data[23] = 'K';
+    data[24] = '\n';
+    cpu.load_instruction_memory(program);
+    cpu.load_data_memory(data);
+
+    sc_start();
+    return log + "output " + console.output;
+}
+
+int sc_main(int, char*[]) {
+    struct Case {
+        const char* name;
+        ExecutionMode mode;
+        bool superblocks;
+    };
+    const Case cases[] = {
+        { "iss, stepping", FUNCTIONAL_ISS, false },
+        { "iss, superblocks", FUNCTIONAL_ISS, true },
+        { "decoupled, stepping", DECOUPLED_ISS, false },
+        { "decoupled, superblocks", DECOUPLED_ISS, true },
+    };
+
+    const std::string first_access = "W 0x30 50 at 10.0 ns\n";
+    int failures = 0;
+    std::string reference;
+    for (const Case& c : cases) {
+        std::string log = run_forked([&] { return run_case(c.mode, c.superblocks); }, "run failed\n");
+        if (reference.empty()) {
+            reference = log;
+            if (log.compare(0, first_access.size(), first_access) != 0 || log.find("output OK\n") == std::string::npos) {
+                std::fprintf(stderr, "FAIL: %s:\n%s\n", c.name, log.c_str());
+                ++failures;
+            }
+        } else if (log != reference) {
+            std::fprintf(stderr, "FAIL: %s differs from %s:\n%s\nexpected:\n%s\n", c.name, cases[0].name,
+                         log.c_str(), reference.c_str());
+            ++failures;
+        }
+    }
+
+    if (failures == 0) {
+        std::printf("device_timing_test: passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+// Superblocks must be indistinguishable from stepping, including to
+// anything the core calls out to in the middle of a run. A recording
+// DataBus logs pc and instructions_executed at every access past the data
+// window; the logs, final states and stop reasons of a core with and
+// without superblocks must be identical.
+#include <systemc.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "decoder.h"
+#include "functional_core.h"
+#include "workloads.h"
+
+struct BusAccess {
+    bool write;
+    unsigned addr;
+    unsigned pc;
+    uint64_t instructions;
+    uint16_t value;
+
+    bool operator==(const BusAccess& other) const {
+        return write == other.write && addr == other.addr && pc == other.pc &&
+               instructions == other.instructions && value == other.value;
+    }
+};
+
+// Backs the addresses past the core's window and logs every access
+class RecordingBus : public DataBus {
+public:
+    FunctionalCore* core = nullptr;
+    std::vector<uint16_t> words = std::vector<uint16_t>(64, 0);
+    std::vector<BusAccess> log;
+
+    uint16_t read(unsigned addr) override {
+        log.push_back({ false, addr, core->pc, core->instructions_executed, words[addr % 64] });
+        return words[addr % 64];
+    }
+    void write(unsigned addr, uint16_t value) override {
+        log.push_back({ true, addr, core->pc, core->instructions_executed, value });
+        words[addr % 64] = value;
+    }
+};
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+// Run program with window words of data memory in the core and the rest on
+// the bus, stepping or in superblocks. The window shrinks halfway through,
+// as when a DMI region is withdrawn.
+static void run(const std::vector<uint16_t>& program, const std::vector<uint16_t>& data, unsigned window,
+                bool superblocks, uint64_t instructions, FunctionalCore& core, RecordingBus& bus) {
+    core.use_superblocks = superblocks;
+    core.report_unknown_opcodes = false;
+    core.load_program(program);
+    std::copy(data.begin(), data.end(), core.memory.begin());
+    std::copy(data.begin(), data.end(), bus.words.begin());
+    bus.core = &core;
+    core.bus = &bus;
+    core.attach_data(core.memory.data(), window);
+    core.run(instructions / 2);
+    core.attach_data(core.memory.data(), window / 2);
+    core.run(instructions - instructions / 2);
+}
+
+// Returns the number of bus accesses
+static size_t compare(const std::vector<uint16_t>& program, const std::vector<uint16_t>& data, unsigned window,
+                    uint64_t instructions) {
+    FunctionalCore stepped, blocked;
+    RecordingBus stepped_bus, blocked_bus;
+    run(program, data, window, false, instructions, stepped, stepped_bus);
+    run(program, data, window, true, instructions, blocked, blocked_bus);
+
+    check(stepped_bus.log.size() == blocked_bus.log.size(), "same number of bus accesses");
+    check(stepped_bus.log == blocked_bus.log, "bus accesses see the same pc and instruction count");
+    check(stepped.pc == blocked.pc && stepped.instructions_executed == blocked.instructions_executed &&
+          stepped.stop_reason == blocked.stop_reason, "same final pc, count and stop reason");
+    check(std::equal(stepped.registers, stepped.registers + NUM_REGISTERS, blocked.registers), "same registers");
+    check(stepped.memory == blocked.memory, "same data memory");
+    return blocked_bus.log.size();
+}
+
+int sc_main(int, char*[]) {
+    for (const Workload& workload : make_workloads()) {
+        std::vector<uint16_t> program(workload.program.begin(), workload.program.end());
+        std::vector<uint16_t> data(workload.data.begin(), workload.data.end());
+        for (unsigned window : { 0u, 16u, 48u, 256u }) {
+            compare(program, data, window, 5000);
+        }
+    }
+
+    // A loop whose body mixes window and bus accesses with a branch
+    std::vector<uint16_t> loop = {
+        encode_instruction(LOAD, 1, 0, 0),   // R1 = 1
+        encode_instruction(LOAD, 2, 0, 1),   // R2 = trip count
+        encode_instruction(LOAD, 3, 0, 40),  // Bus
+        encode_alu(ADD, 3, 3, 1),
+        encode_instruction(STORE, 0, 3, 40), // Bus
+        encode_instruction(STORE, 0, 3, 2),  // Window
+        encode_alu(SUB, 2, 2, 1),
+        encode_branch(BNEZ, 2, -5),
+        0                                    // HALT
+    };
+    std::vector<uint16_t> data(64, 0);
+    data[0] = 1;
+    data[1] = 100;
+    check(compare(loop, data, 32, 10000) > 0, "the loop reaches the bus");
+
+    if (failures == 0) {
+        std::printf("superblock_test: passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
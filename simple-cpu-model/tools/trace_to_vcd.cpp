@@ -0,0 +1,110 @@
+// Convert a trace written with --trace-stream (see trace_stream.h) to VCD.
+//
+// The VCD has the fetched pc and instruction, one variable per register
+// holding its last written value, and the address and value of the last
+// data memory write and read. Register reads are left out.
+//
+// usage: simple_cpu_trace_to_vcd TRACE_FILE [VCD_FILE]
+#include <systemc.h>
+#include <cstdio>
+#include <string>
+#include "common.h"
+#include "trace_stream.h"
+
+// VCD identifiers, one printable character each
+enum VcdVar {
+    VAR_PC,
+    VAR_INSTRUCTION,
+    VAR_MEM_WRITE_ADDR,
+    VAR_MEM_WRITE_DATA,
+    VAR_MEM_READ_ADDR,
+    VAR_MEM_READ_DATA,
+    VAR_REGISTER_0
+};
+
+static char var_id(unsigned var) {
+    return static_cast<char>('!' + var);
+}
+
+static void write_value(FILE* out, uint64_t value, unsigned width, unsigned var) {
+    char bits[65];
+    for (unsigned i = 0; i < width; ++i) {
+        bits[i] = (value >> (width - 1 - i)) & 1 ? '1' : '0';
+    }
+    bits[width] = '\0';
+    std::fprintf(out, "b%s %c\n", bits, var_id(var));
+}
+
+// The timescale is the SystemC time resolution, a power of ten
+static std::string timescale(uint64_t fs) {
+    static const char* units[] = { "fs", "ps", "ns", "us", "ms", "s" };
+    unsigned unit = 0;
+    while (fs >= 1000 && fs % 1000 == 0 && unit < 5) {
+        fs /= 1000;
+        ++unit;
+    }
+    return std::to_string(fs) + " " + units[unit];
+}
+
+int sc_main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::fprintf(stderr, "usage: %s TRACE_FILE [VCD_FILE]\n", argv[0]);
+        return 1;
+    }
+    TraceReader reader;
+    if (!reader.open(argv[1])) {
+        return 1;
+    }
+    FILE* out = argc == 3 ? std::fopen(argv[2], "w") : stdout;
+    if (out == nullptr) {
+        std::perror(argv[2]);
+        return 1;
+    }
+
+    const unsigned data_width = reader.data_addr_size;
+    std::fprintf(out, "$timescale %s $end\n", timescale(reader.resolution_fs).c_str());
+    std::fprintf(out, "$scope module cpu $end\n");
+    std::fprintf(out, "$var wire %u %c pc $end\n", reader.addr_size, var_id(VAR_PC));
+    std::fprintf(out, "$var wire %d %c instruction $end\n", WORD_SIZE, var_id(VAR_INSTRUCTION));
+    std::fprintf(out, "$var wire %u %c mem_write_addr $end\n", data_width, var_id(VAR_MEM_WRITE_ADDR));
+    std::fprintf(out, "$var wire %d %c mem_write_data $end\n", WORD_SIZE, var_id(VAR_MEM_WRITE_DATA));
+    std::fprintf(out, "$var wire %u %c mem_read_addr $end\n", data_width, var_id(VAR_MEM_READ_ADDR));
+    std::fprintf(out, "$var wire %d %c mem_read_data $end\n", WORD_SIZE, var_id(VAR_MEM_READ_DATA));
+    for (int r = 0; r < NUM_REGISTERS; ++r) {
+        std::fprintf(out, "$var wire %d %c r%d $end\n", WORD_SIZE, var_id(VAR_REGISTER_0 + r), r);
+    }
+    std::fprintf(out, "$upscope $end\n$enddefinitions $end\n");
+
+    TraceRecord rec;
+    uint64_t records = 0;
+    bool first = true;
+    uint64_t time = 0;
+    while (reader.next(rec)) {
+        ++records;
+        if (first || rec.time != time) {
+            std::fprintf(out, "#%llu\n", static_cast<unsigned long long>(rec.time));
+            time = rec.time;
+            first = false;
+        }
+        switch (rec.module) {
+            case TRACE_FETCH:
+                write_value(out, rec.addr, reader.addr_size, VAR_PC);
+                write_value(out, rec.value, WORD_SIZE, VAR_INSTRUCTION);
+                break;
+            case TRACE_REGISTER_FILE:
+                if (rec.write) {
+                    write_value(out, rec.value, WORD_SIZE, VAR_REGISTER_0 + rec.addr % NUM_REGISTERS);
+                }
+                break;
+            case TRACE_DATA_MEMORY:
+                write_value(out, rec.addr, data_width, rec.write ? VAR_MEM_WRITE_ADDR : VAR_MEM_READ_ADDR);
+                write_value(out, rec.value, WORD_SIZE, rec.write ? VAR_MEM_WRITE_DATA : VAR_MEM_READ_DATA);
+                break;
+        }
+    }
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    std::fprintf(stderr, "%llu records converted\n", static_cast<unsigned long long>(records));
+    return 0;
+}